@@ -4,12 +4,13 @@ import { type ControlCommandFnMap, type MediaCommandFnMap, type ControlCommand,
 export function createControlCommand<K extends keyof ControlCommandFnMap>(
     fn: K,
     args: ControlCommandFnMap[K],
-    hash: string
+    hash: string,
+    id?: string
 ): ControlCommand<K> {
     return {
         type: CommandType.Control,
-        data: { fn, args, hash }
-    };
+        data: { fn, args, hash, ...(id ? { id } : {}) }
+    } as ControlCommand<K>;
 }
 
 export function createMediaCommand<K extends keyof MediaCommandFnMap>(
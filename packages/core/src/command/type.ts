@@ -11,6 +11,11 @@ export type BaseCommandData = {
 	hash?: string;
 };
 
+export type SceneOperation = {
+	fn: 'volume' | 'mute' | 'brightness' | 'playMedia' | 'pauseMedia' | 'nextTrack' | 'previousTrack' | 'seekTo' | 'lock' | 'sleep' | 'shutdown' | 'restart';
+	args?: Record<string, unknown>;
+};
+
 export interface ControlCommandFnMap {
 	lock: {};
 	shutdown: {};
@@ -20,6 +25,9 @@ export interface ControlCommandFnMap {
 	volume: { level: number };
 	brightness: { level: number };
 	goodnight: {};
+	runScene: { ops: SceneOperation[] };
+	setTracing: { enabled: boolean };
+	dumpTrace: {};
 }
 
 export type ControlCommandData<K extends keyof ControlCommandFnMap = keyof ControlCommandFnMap> = {
@@ -27,6 +35,7 @@ export type ControlCommandData<K extends keyof ControlCommandFnMap = keyof Contr
 		fn: P;
 		args: ControlCommandFnMap[P];
 		hash: string;
+		id?: string;
 	}
 }[K];
 
@@ -95,6 +95,10 @@ export class ToolClassifier extends Singleton {
 			theme: 'device',
 			description: 'Lock a device',
 		},
+		DEVICE_SCENE: {
+			theme: 'device',
+			description: 'Change several device settings at once (e.g. movie mode: dim screen, lower volume, play)',
+		},
 		ROUTINE_GOOD_NIGHT: {
 			theme: 'routine',
 			description:
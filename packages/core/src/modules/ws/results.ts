@@ -0,0 +1,48 @@
+// Pending control results
+// Control commands sent with an id are answered by the link with a ControlResult;
+// callers wait on the id here until it arrives or times out.
+
+import type { ControlResultWSData } from "./type.js";
+
+type ControlResult = ControlResultWSData['data'];
+
+interface Pending {
+	resolve: (result: ControlResult | null) => void;
+	timer: ReturnType<typeof setTimeout>;
+}
+
+class ControlResults {
+	private pending = new Map<string, Pending>();
+
+	/**
+	 * Register an id to wait on. Resolves with null if no result arrives in time.
+	 */
+	wait(id: string, timeoutMs: number): Promise<ControlResult | null> {
+		return new Promise((resolve) => {
+			const timer = setTimeout(() => {
+				this.pending.delete(id);
+				resolve(null);
+			}, timeoutMs);
+
+			this.pending.set(id, { resolve, timer });
+		});
+	}
+
+	/**
+	 * Deliver a result from a link
+	 * @returns whether someone was waiting for it
+	 */
+	resolve(result: ControlResult): boolean {
+		const entry = this.pending.get(result.id);
+		if (!entry) {
+			return false;
+		}
+
+		clearTimeout(entry.timer);
+		this.pending.delete(result.id);
+		entry.resolve(result);
+		return true;
+	}
+}
+
+export const controlResults = new ControlResults();
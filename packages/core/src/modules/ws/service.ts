@@ -1,12 +1,13 @@
 import { safe, type ErrorBase, type Result } from "@yumi/results";
 import type { ElysiaWS } from "elysia/ws";
 import { logger, wslog } from "../../integrations/logger/index.js";
-import { WSType, type AckWSData, type ControlWSData, type DeviceWSData, type DeviceStateWSData, type HeartbeatWSData, type MusicWSData, type WSData } from "./type.js";
+import { WSType, type AckWSData, type ControlWSData, type ControlResultWSData, type DeviceWSData, type DeviceStateWSData, type HeartbeatWSData, type MusicWSData, type WSData } from "./type.js";
 import { devicePool, DeviceType } from "../../pool/devices/index.js";
 import { mediaStatePool } from "../../pool/media/index.js";
 import { statDB } from "../../db/index.js";
 import { executeCommand, relayCommand } from "../../command/handler.js";
 import { artworkCache } from "./artwork.js";
+import { controlResults } from "./results.js";
 
 export abstract class Websocket {
 	static async handle(ws: ElysiaWS, message: string): Promise<void> {
@@ -36,6 +37,8 @@ export abstract class Websocket {
 				return this.#handleMusic(ws, data);
 			case WSType.Control:
 				return this.#handleControl(ws, data);
+			case WSType.ControlResult:
+				return this.#handleControlResult(ws, data);
 			case WSType.Heartbeat:
 				return this.#handleHeartbeat(ws, data);
 			case WSType.DeviceState:
@@ -150,6 +153,22 @@ export abstract class Websocket {
 		}
 	}
 
+	static async #handleControlResult(ws: ElysiaWS, data: ControlResultWSData): Promise<void> {
+		const end = wslog.time();
+
+		if (!devicePool.has(ws.id)) {
+			wslog.withMetrics({ duration: end() }).warn(`Device not found in pool for control result: ${ws.id}`);
+			ws.close(1000, 'Device not registered');
+			return;
+		}
+
+		if (!controlResults.resolve(data.data)) {
+			wslog.withMetrics({ duration: end() }).debug(`Control result for ${data.data.fn} arrived after its caller gave up: ${data.data.id}`);
+			return;
+		}
+		wslog.withMetrics({ duration: end() }).info(`Control result received from ${data.data.hash}: ${data.data.fn} ok=${data.data.ok}`);
+	}
+
 	static async #handleHeartbeat(ws: ElysiaWS, data: HeartbeatWSData): Promise<void> {
 		const end = wslog.time();
 
@@ -1,4 +1,4 @@
-import type { DeviceType } from "../../pool/devices/index.js";
+import type { DeviceCapabilities, DeviceType } from "../../pool/devices/index.js";
 
 export enum WSType {
 	Device = "device",
@@ -8,6 +8,7 @@ export enum WSType {
 	Heartbeat = "heartbeat",
 	DeviceState = "deviceState",
 	Speak = "speak",
+	ControlResult = "controlResult",
 }
 
 export type DeviceWSData = {
@@ -17,9 +18,16 @@ export type DeviceWSData = {
 		type: DeviceType;
 		name: string;
 		identifier: string;
+		capabilities?: DeviceCapabilities;
 	}
 }
 
+export type ArtworkPalette = {
+	dominant: string;
+	accent: string;
+	colors: { color: string; weight: number }[];
+}
+
 export type MusicWSData = {
 	type: WSType.Music;
 	data: {
@@ -31,6 +39,7 @@ export type MusicWSData = {
 		positionFormatted?: string;
 		status?: 'Playing' | 'Paused' | 'stopped';
 		artwork?: string | null; // undefined = omit, null = clear, string = URL or base64
+		palette?: ArtworkPalette | null; // dominant/accent colors of the artwork
 		hash: string;
 	}
 }
@@ -50,6 +59,19 @@ export type ControlWSData = {
 		fn: string;
 		args?: Record<string, unknown>;
 		hash: string;
+		id?: string; // set when the sender waits for a ControlResult
+	}
+}
+
+export type ControlResultWSData = {
+	type: WSType.ControlResult;
+	data: {
+		id: string;
+		fn: string;
+		ok: boolean;
+		result?: unknown;
+		error?: string;
+		hash: string;
 	}
 }
 
@@ -74,4 +96,4 @@ export type SpeakWSData = {
 	}
 }
 
-export type WSData = DeviceWSData | MusicWSData | ControlWSData | AckWSData | HeartbeatWSData | DeviceStateWSData | SpeakWSData;
\ No newline at end of file
+export type WSData = DeviceWSData | MusicWSData | ControlWSData | ControlResultWSData | AckWSData | HeartbeatWSData | DeviceStateWSData | SpeakWSData;
\ No newline at end of file
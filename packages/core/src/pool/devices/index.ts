@@ -11,12 +11,21 @@ export enum DeviceType {
 	Server = 'server',
 }
 
+export type DeviceCapabilities = {
+	media: boolean;
+	palette?: boolean;
+	volume: boolean;
+	brightness: boolean;
+	power: boolean;
+}
+
 export type Device = {
 	hash: string;
 	name: string;
 	type: DeviceType;
 	identifier: string;
 	status?: 'online' | 'offline';
+	capabilities?: DeviceCapabilities;
 }
 
 export class Pool extends Singleton {
@@ -68,6 +77,19 @@ export class Pool extends Singleton {
 		return Result.err(PoolError.DeviceNotFound);
 	}
 
+	/**
+	 * Whether the device with this hash reported support for a capability.
+	 * Devices that did not report capabilities (older links) are assumed capable.
+	 */
+	supports(hash: string, capability: keyof DeviceCapabilities): boolean {
+		const device = this.findByHash(hash);
+		if (device.isErr()) {
+			return true;
+		}
+
+		return device.unwrap()!.capabilities?.[capability] ?? true;
+	}
+
 	get decks(): Device[] {
 		return this.list().filter(device => device.type === DeviceType.Deck);
 	}
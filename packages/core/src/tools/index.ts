@@ -37,7 +37,8 @@ export const DEVICE_TOOLS = new Set([
 	'muteDevice',
 	'shutdownDevice',
 	'sleepDevice',
-	'lockDevice'
+	'lockDevice',
+	'runDeviceScene'
 ]);
 
 /** Media control tools - these should target devices that are actively playing */
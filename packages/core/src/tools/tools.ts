@@ -3,10 +3,12 @@
  */
 import type Elysia from 'elysia';
 import { createControlCommand, createMediaCommand } from '../command/index.js';
+import type { SceneOperation } from '../command/type.js';
 import ledfx, { LedFxScene, type LedFx } from '../integrations/ledfx';
-import { devicePool } from '../pool/devices/index.js';
+import { devicePool, type DeviceCapabilities } from '../pool/devices/index.js';
 import { type ElysiaWS } from 'elysia/ws';
 import { mediaStatePool } from '../pool/media/index.js';
+import { controlResults } from '../modules/ws/results.js';
 
 /**
  * Change the scene of a WLED light using LEDfx.
@@ -70,7 +72,7 @@ export function getCurrentTime(): string {
  * @returns boolean - success status
  */
 export function playMedia(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'media')) {
 		return false;
 	}
 
@@ -88,7 +90,7 @@ export function playMedia(this: ElysiaWS, { hash }: { hash: string }): boolean {
  * @returns boolean - success status
  */
 export function pauseMedia(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'media')) {
 		return false;
 	}
 	
@@ -106,7 +108,7 @@ export function pauseMedia(this: ElysiaWS, { hash }: { hash: string }): boolean
  * @returns boolean - success status
  */
 export function stopMedia(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'media')) {
 		return false;
 	}
 
@@ -124,7 +126,7 @@ export function stopMedia(this: ElysiaWS, { hash }: { hash: string }): boolean {
  * @returns boolean - success status
  */
 export function nextMediaTrack(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'media')) {
 		return false;
 	}
 
@@ -142,7 +144,7 @@ export function nextMediaTrack(this: ElysiaWS, { hash }: { hash: string }): bool
  * @returns boolean - success status
  */
 export function previousMediaTrack(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'media')) {
 		return false;
 	}
 
@@ -164,7 +166,7 @@ export function setMediaVolume(
 	this: Elysia['server'],
 	{ hash, volume }: { hash: string; volume: number },
 ): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'volume')) {
 		return false;
 	}
 
@@ -186,7 +188,7 @@ export function setMediaVolume(
  * @returns boolean - success status
  */
 export function shutdownDevice(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'power')) {
 		return false;
 	}
 
@@ -208,7 +210,7 @@ export function muteDevice(
 	this: ElysiaWS,
 	{ hash, muted }: { hash: string; muted: boolean },
 ): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'volume')) {
 		return false;
 	}
 
@@ -230,7 +232,7 @@ export function sleepDevice(
 	this: ElysiaWS,
 	{ hash, duration }: { hash: string; duration: number },
 ): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'power')) {
 		return false;
 	}
 
@@ -248,7 +250,7 @@ export function sleepDevice(
  * @returns boolean - success status
  */
 export function lockDevice(this: ElysiaWS, { hash }: { hash: string }): boolean {
-	if (!hash) {
+	if (!hash || !devicePool.supports(hash, 'power')) {
 		return false;
 	}
 
@@ -256,6 +258,94 @@ export function lockDevice(this: ElysiaWS, { hash }: { hash: string }): boolean
 	return true;
 }
 
+/** Capability a link must report for each scene operation */
+const SCENE_CAPABILITIES: Record<SceneOperation['fn'], keyof DeviceCapabilities> = {
+	volume: 'volume',
+	mute: 'volume',
+	brightness: 'brightness',
+	playMedia: 'media',
+	pauseMedia: 'media',
+	nextTrack: 'media',
+	previousTrack: 'media',
+	seekTo: 'media',
+	lock: 'power',
+	sleep: 'power',
+	shutdown: 'power',
+	restart: 'power',
+};
+
+/** How long to wait for the link to report a scene's per-operation results */
+const SCENE_RESULT_TIMEOUT_MS = 10000;
+
+/**
+ * Apply several device and media changes in one go
+ *
+ * The link applies operations on different resources (audio, display, media) in
+ * parallel and power operations (lock, sleep, shutdown, restart) last. Operations
+ * the device does not support are skipped; the rest are reported individually.
+ *
+ * Operations and their args:
+ * - volume: { level } from 0 to 1 (0.4 is 40%), unlike setMediaVolume which takes 0-100
+ * - mute: { muted } true or false
+ * - brightness: { level } from 0 to 100 percent
+ * - seekTo: { position } in seconds from the start of the track
+ * - playMedia, pauseMedia, nextTrack, previousTrack, lock, sleep, shutdown, restart: no args
+ *
+ * @intent DEVICE_SCENE
+ * @param params.hash - device Hash
+ * @param params.ops - operations as listed above, e.g. { fn: 'volume', args: { level: 0.4 } }
+ *
+ * @example
+ * ```ts
+ * // movie mode
+ * await runDeviceScene({ hash, ops: [
+ *   { fn: 'brightness', args: { level: 20 } },
+ *   { fn: 'volume', args: { level: 0.4 } },
+ *   { fn: 'playMedia' },
+ * ] });
+ * ```
+ *
+ * @this {ElysiaWS}
+ * @returns per-operation results; throws when no operation could be applied
+ */
+export async function runDeviceScene(
+	this: ElysiaWS,
+	{ hash, ops }: { hash: string; ops: SceneOperation[] },
+): Promise<{ results: { fn: string; ok: boolean; error?: string }[] }> {
+	if (!hash || !Array.isArray(ops) || ops.length === 0) {
+		throw new Error('runDeviceScene requires a device hash and at least one operation');
+	}
+
+	const supported = ops.filter((op) => devicePool.supports(hash, SCENE_CAPABILITIES[op.fn]));
+	const skipped = ops
+		.filter((op) => !supported.includes(op))
+		.map((op) => ({ fn: op.fn, ok: false, error: `device does not support ${SCENE_CAPABILITIES[op.fn] ?? op.fn}` }));
+
+	if (supported.length === 0) {
+		throw new Error(`No scene operation is supported by the device: ${skipped.map((op) => op.fn).join(', ')}`);
+	}
+
+	const id = crypto.randomUUID();
+	const pending = controlResults.wait(id, SCENE_RESULT_TIMEOUT_MS);
+	this.publish(hash, JSON.stringify(createControlCommand('runScene', { ops: supported }, hash, id)));
+
+	const reply = await pending;
+	if (!reply) {
+		throw new Error('Device did not report scene results in time');
+	}
+	if (!reply.ok) {
+		throw new Error(`Scene failed: ${reply.error ?? 'unknown error'}`);
+	}
+
+	const scene = reply.result as { results?: { fn: string; ok: boolean; error?: string }[] } | undefined;
+	const results = [...(scene?.results ?? []), ...skipped];
+	if (!results.some((op) => op.ok)) {
+		throw new Error(`No scene operation succeeded: ${results.map((op) => `${op.fn} (${op.error ?? 'failed'})`).join(', ')}`);
+	}
+
+	return { results };
+}
+
 // routines
 
 /**
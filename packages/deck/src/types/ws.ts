@@ -25,6 +25,12 @@ export interface DeviceWSData {
 	};
 }
 
+export interface ArtworkPalette {
+	dominant: string; // #rrggbb
+	accent: string; // #rrggbb
+	colors: { color: string; weight: number }[];
+}
+
 export interface MusicWSData {
 	type: WSType.Music;
 	data: {
@@ -36,6 +42,7 @@ export interface MusicWSData {
 		positionFormatted?: string;
 		status?: 'playing' | 'paused' | 'stopped';
 		artwork?: string | null; // undefined = keep existing, null = clear, string = new artwork
+		palette?: ArtworkPalette | null; // dominant/accent colors of the artwork, null = none
 		hash: string;
 	};
 }
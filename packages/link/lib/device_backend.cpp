@@ -0,0 +1,468 @@
+#include "device_backend.hpp"
+#include "probe.hpp"
+#include "reactor.hpp"
+#include "trace.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    #include <mmdeviceapi.h>
+    #include <endpointvolume.h>
+    #include <comdef.h>
+    #include <Wbemidl.h>
+#else
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/epoll.h>
+    #include <unistd.h>
+#endif
+
+namespace device_backend {
+namespace {
+
+#if defined(_WIN32) || defined(_WIN64)
+
+// Handles below are only touched on the reactor thread
+IMMDeviceEnumerator* g_enumerator = nullptr;
+IAudioEndpointVolume* g_endpoint = nullptr;
+
+void reset_endpoint() {
+    if (g_endpoint) g_endpoint->Release();
+    g_endpoint = nullptr;
+}
+
+// Drops the cached endpoint when the default output device changes
+class DefaultDeviceWatcher : public IMMNotificationClient {
+public:
+    ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&refs); }
+
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG remaining = InterlockedDecrement(&refs);
+        if (remaining == 0) delete this;
+        return remaining;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override {
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient)) {
+            *ppv = static_cast<IMMNotificationClient*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow flow, ERole role, LPCWSTR) override {
+        if (flow == eRender && role == eConsole) reactor::post(reset_endpoint);
+        return S_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { return S_OK; }
+
+private:
+    LONG refs = 1;
+};
+
+IAudioEndpointVolume* endpoint() {
+    if (!g_enumerator) {
+        if (FAILED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                    __uuidof(IMMDeviceEnumerator), (void**)&g_enumerator))) {
+            g_enumerator = nullptr;
+            return nullptr;
+        }
+        g_enumerator->RegisterEndpointNotificationCallback(new DefaultDeviceWatcher());
+    }
+
+    if (!g_endpoint) {
+        IMMDevice* pDevice = nullptr;
+        if (SUCCEEDED(g_enumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice))) {
+            if (FAILED(pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr, (void**)&g_endpoint))) {
+                g_endpoint = nullptr;
+            }
+            pDevice->Release();
+        }
+    }
+
+    return g_endpoint;
+}
+
+// Run an endpoint call on the reactor thread, retrying once on a fresh endpoint
+// if the cached one was invalidated (device unplugged, driver restart)
+template <typename Fn>
+HRESULT with_endpoint(Fn fn) {
+    return reactor::call([&fn]() -> HRESULT {
+        TRACE_SCOPE("IAudioEndpointVolume", "com");
+        IAudioEndpointVolume* pEndpoint = endpoint();
+        HRESULT hr = pEndpoint ? fn(pEndpoint) : E_FAIL;
+        if (FAILED(hr)) {
+            reset_endpoint();
+            pEndpoint = endpoint();
+            hr = pEndpoint ? fn(pEndpoint) : E_FAIL;
+        }
+        return hr;
+    });
+}
+
+// ROOT\WMI connection for the monitor brightness classes, opened on the reactor
+// thread on first use and kept for later calls
+IWbemServices* g_wmi = nullptr;
+
+void reset_wmi() {
+    if (g_wmi) g_wmi->Release();
+    g_wmi = nullptr;
+}
+
+IWbemServices* wmi() {
+    if (g_wmi) return g_wmi;
+
+    IWbemLocator* pLocator = nullptr;
+    if (FAILED(CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
+                                IID_IWbemLocator, (void**)&pLocator))) {
+        return nullptr;
+    }
+
+    IWbemServices* pServices = nullptr;
+    HRESULT hr = pLocator->ConnectServer(_bstr_t(L"ROOT\\WMI"), nullptr, nullptr, nullptr, 0, nullptr, nullptr, &pServices);
+    pLocator->Release();
+    if (FAILED(hr)) return nullptr;
+
+    CoSetProxyBlanket(pServices, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, nullptr, RPC_C_AUTHN_LEVEL_CALL,
+                      RPC_C_IMP_LEVEL_IMPERSONATE, nullptr, EOAC_NONE);
+    g_wmi = pServices;
+    return g_wmi;
+}
+
+// First instance of a WMI class (the internal panel), or nullptr
+IWbemClassObject* first_instance(IWbemServices* pServices, const wchar_t* className) {
+    IEnumWbemClassObject* pEnumerator = nullptr;
+    if (FAILED(pServices->CreateInstanceEnum(_bstr_t(className), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY,
+                                             nullptr, &pEnumerator))) {
+        return nullptr;
+    }
+
+    IWbemClassObject* pObject = nullptr;
+    ULONG returned = 0;
+    HRESULT hr = pEnumerator->Next(WBEM_INFINITE, 1, &pObject, &returned);
+    pEnumerator->Release();
+    return SUCCEEDED(hr) && returned > 0 ? pObject : nullptr;
+}
+
+// WmiMonitorBrightness.CurrentBrightness, or -1
+int read_wmi_brightness(IWbemServices* pServices) {
+    IWbemClassObject* pMonitor = first_instance(pServices, L"WmiMonitorBrightness");
+    if (!pMonitor) return -1;
+
+    int level = -1;
+    VARIANT value;
+    VariantInit(&value);
+    if (SUCCEEDED(pMonitor->Get(L"CurrentBrightness", 0, &value, nullptr, nullptr)) && value.vt == VT_UI1) {
+        level = value.bVal;
+    }
+    VariantClear(&value);
+    pMonitor->Release();
+    return level;
+}
+
+// WmiMonitorBrightnessMethods.WmiSetBrightness(Timeout = 0, Brightness = level)
+bool write_wmi_brightness(IWbemServices* pServices, int level) {
+    IWbemClassObject* pMethods = first_instance(pServices, L"WmiMonitorBrightnessMethods");
+    if (!pMethods) return false;
+
+    IWbemClassObject* pClass = nullptr;
+    IWbemClassObject* pSignature = nullptr;
+    IWbemClassObject* pParams = nullptr;
+    VARIANT path;
+    VariantInit(&path);
+
+    bool ok = false;
+    if (SUCCEEDED(pMethods->Get(L"__PATH", 0, &path, nullptr, nullptr)) && path.vt == VT_BSTR &&
+        SUCCEEDED(pServices->GetObject(_bstr_t(L"WmiMonitorBrightnessMethods"), 0, nullptr, &pClass, nullptr)) &&
+        SUCCEEDED(pClass->GetMethod(L"WmiSetBrightness", 0, &pSignature, nullptr)) &&
+        SUCCEEDED(pSignature->SpawnInstance(0, &pParams))) {
+        VARIANT timeout;
+        VariantInit(&timeout);
+        timeout.vt = VT_I4;
+        timeout.lVal = 0;
+
+        VARIANT brightness;
+        VariantInit(&brightness);
+        brightness.vt = VT_UI1;
+        brightness.bVal = static_cast<BYTE>(level);
+
+        ok = SUCCEEDED(pParams->Put(L"Timeout", 0, &timeout, 0)) &&
+             SUCCEEDED(pParams->Put(L"Brightness", 0, &brightness, 0)) &&
+             SUCCEEDED(pServices->ExecMethod(path.bstrVal, _bstr_t(L"WmiSetBrightness"), 0, nullptr, pParams, nullptr, nullptr));
+    }
+
+    VariantClear(&path);
+    if (pParams) pParams->Release();
+    if (pSignature) pSignature->Release();
+    if (pClass) pClass->Release();
+    pMethods->Release();
+    return ok;
+}
+
+// Run a WMI call on the reactor thread, reconnecting once if it failed on the
+// cached connection (WMI service restart)
+template <typename Fn>
+bool with_wmi(Fn fn) {
+    return reactor::call([&fn] {
+        TRACE_SCOPE("WmiMonitorBrightness", "com");
+        IWbemServices* pServices = wmi();
+        if (pServices && fn(pServices)) return true;
+        reset_wmi();
+        pServices = wmi();
+        return pServices && fn(pServices);
+    });
+}
+
+#else
+
+// Cached state; negative until the first successful read
+std::atomic<float> g_volume{-1.0f};
+std::atomic<int> g_brightness{-1};
+std::atomic<bool> g_volumeRefreshPending{false};
+std::atomic<bool> g_brightnessRefreshPending{false};
+
+bool g_hasPactl = false;
+bool g_hasBrightnessctl = false;
+
+// Backlight attribute watched for kernel change notifications
+int g_backlightFd = -1;
+long g_backlightMax = 0;
+
+// First percentage in `pactl get-sink-volume` output ("... / 42% / ..."), or -1
+int parse_volume_percent(const std::string& output) {
+    size_t percent = output.find('%');
+    if (percent == std::string::npos) return -1;
+
+    size_t start = percent;
+    while (start > 0 && output[start - 1] >= '0' && output[start - 1] <= '9') --start;
+    if (start == percent) return -1;
+    return std::atoi(output.c_str() + start);
+}
+
+// Re-read the sink volume without blocking the reactor; done (if set) runs on
+// the reactor thread once the cache is updated or the read failed
+void refresh_volume(std::function<void()> done = nullptr) {
+    reactor::capture({"pactl", "get-sink-volume", "@DEFAULT_SINK@"},
+                     [done = std::move(done)](int code, const std::string& output) {
+                         int percent = code == 0 ? parse_volume_percent(output) : -1;
+                         // Keep the last known value when the read failed
+                         if (percent >= 0) g_volume = static_cast<float>(percent) / 100.0f;
+                         if (done) done();
+                     });
+}
+
+// pactl emits bursts of events per change; re-read once they settle
+void volume_changed() {
+    if (g_volumeRefreshPending.exchange(true)) return;
+    reactor::schedule(50, [] {
+        g_volumeRefreshPending = false;
+        refresh_volume();
+    });
+}
+
+// Percentage field of `brightnessctl -m` output
+// ("intel_backlight,backlight,1200,50%,2400"), or -1
+int parse_brightness_percent(const std::string& output) {
+    size_t start = 0;
+    for (int field = 0; field < 3; ++field) {
+        start = output.find(',', start);
+        if (start == std::string::npos) return -1;
+        ++start;
+    }
+    if (start >= output.size() || output[start] < '0' || output[start] > '9') return -1;
+    return std::atoi(output.c_str() + start);
+}
+
+// Re-read brightness through brightnessctl (when there is no backlight attribute
+// to watch) without blocking the reactor; done (if set) runs on the reactor
+// thread once the cache is updated or the read failed
+void refresh_brightness(std::function<void()> done = nullptr) {
+    reactor::capture({"brightnessctl", "-m"}, [done = std::move(done)](int code, const std::string& output) {
+        int percent = code == 0 ? parse_brightness_percent(output) : -1;
+        if (percent >= 0) g_brightness = percent;
+        if (done) done();
+    });
+}
+
+// Integer value of a sysfs attribute, or -1
+long read_attribute(int fd) {
+    char buffer[32];
+    ssize_t got = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (got <= 0) return -1;
+    buffer[got] = '\0';
+    return std::strtol(buffer, nullptr, 10);
+}
+
+int read_backlight() {
+    TRACE_SCOPE("backlight", "sysfs");
+    long value = read_attribute(g_backlightFd);
+    if (value < 0 || g_backlightMax <= 0) return -1;
+    return static_cast<int>((value * 100 + g_backlightMax / 2) / g_backlightMax);
+}
+
+void open_backlight() {
+    DIR* dir = opendir("/sys/class/backlight");
+    if (!dir) return;
+
+    std::string device;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            device = std::string("/sys/class/backlight/") + entry->d_name;
+            break;
+        }
+    }
+    closedir(dir);
+    if (device.empty()) return;
+
+    int max_fd = open((device + "/max_brightness").c_str(), O_RDONLY | O_CLOEXEC);
+    if (max_fd < 0) return;
+    g_backlightMax = read_attribute(max_fd);
+    close(max_fd);
+
+    g_backlightFd = open((device + "/actual_brightness").c_str(), O_RDONLY | O_CLOEXEC);
+    if (g_backlightFd < 0 || g_backlightMax <= 0) return;
+
+    g_brightness = read_backlight();
+
+    // sysfs_notify wakes pollers of the attribute with POLLPRI on every change
+    reactor::add_fd(g_backlightFd, EPOLLPRI | EPOLLERR, [](uint32_t) {
+        int level = read_backlight();
+        if (level >= 0) g_brightness = level;
+    });
+}
+
+void start() {
+    static std::once_flag started;
+    std::call_once(started, [] {
+        g_hasPactl = probe::has_executable("pactl");
+        if (g_hasPactl) {
+            reactor::follow_process(
+                {"pactl", "subscribe"},
+                [](const std::string& line) {
+                    if (line.find("on sink") != std::string::npos || line.find("on server") != std::string::npos) {
+                        volume_changed();
+                    }
+                },
+                volume_changed);
+        }
+        g_hasBrightnessctl = probe::has_executable("brightnessctl");
+        open_backlight();
+    });
+}
+
+#endif
+
+} // namespace
+
+// === VOLUME ===
+float get_volume() {
+#if defined(_WIN32) || defined(_WIN64)
+    float level = 0.0f;
+    with_endpoint([&level](IAudioEndpointVolume* pEndpoint) {
+        return pEndpoint->GetMasterVolumeLevelScalar(&level);
+    });
+    return level;
+#else
+    start();
+    if (g_volume < 0 && g_hasPactl) {
+        // First read: wait (bounded) for it rather than report a placeholder
+        auto read = std::make_shared<std::promise<void>>();
+        std::future<void> ready = read->get_future();
+        refresh_volume([read] { read->set_value(); });
+        ready.wait_for(std::chrono::milliseconds(2000));
+    }
+    float level = g_volume;
+    return level < 0 ? 0.5f : level;
+#endif
+}
+
+bool set_volume(float level) {
+#if defined(_WIN32) || defined(_WIN64)
+    return SUCCEEDED(with_endpoint([level](IAudioEndpointVolume* pEndpoint) {
+        return pEndpoint->SetMasterVolumeLevelScalar(level, nullptr);
+    }));
+#else
+    start();
+    if (reactor::run({"pactl", "set-sink-volume", "@DEFAULT_SINK@", std::to_string(level * 100.0f) + "%"}) != 0) {
+        return false;
+    }
+    g_volume = level;
+    return true;
+#endif
+}
+
+bool set_mute(bool shouldMute) {
+#if defined(_WIN32) || defined(_WIN64)
+    return SUCCEEDED(with_endpoint([shouldMute](IAudioEndpointVolume* pEndpoint) {
+        return pEndpoint->SetMute(shouldMute, nullptr);
+    }));
+#else
+    (void)shouldMute;
+    start();
+    return reactor::run({"pactl", "set-sink-mute", "@DEFAULT_SINK@", "toggle"}) == 0;
+#endif
+}
+
+// === BRIGHTNESS ===
+int get_brightness() {
+#if defined(_WIN32) || defined(_WIN64)
+    int level = -1;
+    with_wmi([&level](IWbemServices* pServices) {
+        level = read_wmi_brightness(pServices);
+        return level >= 0;
+    });
+    return level < 0 ? 50 : level;
+#else
+    start();
+    if (g_backlightFd >= 0) {
+        int level = g_brightness;
+        return level < 0 ? 50 : level;
+    }
+    if (!g_hasBrightnessctl) return 50;
+
+    // No watchable backlight: serve the last brightnessctl reading and refresh it
+    // in the background, one read at a time
+    if (g_brightness >= 0) {
+        if (!g_brightnessRefreshPending.exchange(true)) {
+            refresh_brightness([] { g_brightnessRefreshPending = false; });
+        }
+    } else {
+        // First read: wait (bounded) for it rather than report a placeholder
+        auto read = std::make_shared<std::promise<void>>();
+        std::future<void> ready = read->get_future();
+        refresh_brightness([read] { read->set_value(); });
+        ready.wait_for(std::chrono::milliseconds(2000));
+    }
+    int level = g_brightness;
+    return level < 0 ? 50 : level;
+#endif
+}
+
+bool set_brightness(int level) {
+#if defined(_WIN32) || defined(_WIN64)
+    return with_wmi([level](IWbemServices* pServices) {
+        return write_wmi_brightness(pServices, level);
+    });
+#else
+    start();
+    if (reactor::run({"brightnessctl", "set", std::to_string(level) + "%"}) != 0) return false;
+    g_brightness = level;
+    return true;
+#endif
+}
+
+} // namespace device_backend
@@ -0,0 +1,27 @@
+#pragma once
+
+// Device backend
+//
+// Volume and brightness state owned by the shared reactor thread (reactor.hpp).
+// Getters read cached values that the reactor keeps current; setters hand the
+// change to the reactor, update the cache right away and return whether the
+// change was applied.
+//
+// Linux: volume follows `pactl subscribe` and is re-read only when the sink
+// changes; brightness is read from /sys/class/backlight and re-read when the
+// kernel notifies the attribute (EPOLLPRI), with `brightnessctl -m` read in the
+// background as a fallback. Nothing goes through a shell.
+// Windows: one IAudioEndpointVolume, created on the reactor thread and replaced
+// when the default output device changes; brightness goes through the WMI
+// monitor classes on the same thread.
+
+namespace device_backend {
+
+float get_volume();
+bool set_volume(float level);
+bool set_mute(bool shouldMute);
+
+int get_brightness();
+bool set_brightness(int level);
+
+} // namespace device_backend
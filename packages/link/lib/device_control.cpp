@@ -1,5 +1,10 @@
 #include <iostream>
+#include <mutex>
 #include <string>
+#include "device_backend.hpp"
+#include "probe.hpp"
+#include "scene.hpp"
+#include "trace.hpp"
 
 #ifdef _WIN32
     #include <windows.h>
@@ -10,7 +15,9 @@
 	#include <comdef.h>
 	#include <shellapi.h>
     #include <PowrProf.h>
+    #include <Wbemidl.h>
     #pragma comment(lib, "PowrProf.lib")
+    #pragma comment(lib, "wbemuuid.lib")
 #else
     #include <cstdlib>
 #endif
@@ -33,160 +40,190 @@ private:
 };
 #endif
 
-// === VOLUME ===
-DEVICECONTROL_API float getVolume() {
+// === CAPABILITIES ===
+// Probed once on first request, never at load time and without spawning processes
+struct Capabilities {
+    bool volume = false;
+    bool brightness = false;
+    bool power = false;
+};
+
 #ifdef _WIN32
+// Brightness goes through WmiMonitorBrightnessMethods, which only exists for
+// panels the OS can dim (laptops, some all-in-ones)
+static bool probeWmiBrightness() {
     ComInitializer comInit;
-    float level = 0.0f;
-
-    IMMDeviceEnumerator* pEnumerator = nullptr;
-    IMMDevice* pDevice = nullptr;
-    IAudioEndpointVolume* pEndpointVolume = nullptr;
-
-    if (SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
-                                   __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator)) &&
-        SUCCEEDED(pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice)) &&
-        SUCCEEDED(pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr, (void**)&pEndpointVolume))) {
-        pEndpointVolume->GetMasterVolumeLevelScalar(&level);
+    bool found = false;
+
+    IWbemLocator* pLocator = nullptr;
+    IWbemServices* pServices = nullptr;
+    IEnumWbemClassObject* pEnumerator = nullptr;
+
+    if (SUCCEEDED(CoCreateInstance(CLSID_WbemLocator, nullptr, CLSCTX_INPROC_SERVER,
+                                   IID_IWbemLocator, (void**)&pLocator)) &&
+        SUCCEEDED(pLocator->ConnectServer(_bstr_t(L"ROOT\\WMI"), nullptr, nullptr, nullptr, 0, nullptr, nullptr, &pServices)) &&
+        SUCCEEDED(pServices->CreateInstanceEnum(_bstr_t(L"WmiMonitorBrightness"), WBEM_FLAG_FORWARD_ONLY, nullptr, &pEnumerator))) {
+        IWbemClassObject* pObject = nullptr;
+        ULONG returned = 0;
+        if (SUCCEEDED(pEnumerator->Next(WBEM_INFINITE, 1, &pObject, &returned)) && returned > 0) {
+            found = true;
+            pObject->Release();
+        }
     }
 
-    if (pEndpointVolume) pEndpointVolume->Release();
-    if (pDevice) pDevice->Release();
     if (pEnumerator) pEnumerator->Release();
-    return level;
-#else
-    // Parse pactl output to get volume
-    FILE* pipe = popen("pactl get-sink-volume @DEFAULT_SINK@ | grep -oP '\\d+(?=%)' | head -1", "r");
-    if (!pipe) return 0.5f;
-    char buffer[128];
-    if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        pclose(pipe);
-        return std::stof(buffer) / 100.0f;
-    }
-    pclose(pipe);
-    return 0.5f;
-#endif
+    if (pServices) pServices->Release();
+    if (pLocator) pLocator->Release();
+    return found;
 }
 
-DEVICECONTROL_API void volume(float level) {
-#ifdef _WIN32
+static bool probeAudioEndpoint() {
     ComInitializer comInit;
+    bool found = false;
 
     IMMDeviceEnumerator* pEnumerator = nullptr;
     IMMDevice* pDevice = nullptr;
-    IAudioEndpointVolume* pEndpointVolume = nullptr;
 
     if (SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
                                    __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator)) &&
-        SUCCEEDED(pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice)) &&
-        SUCCEEDED(pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr, (void**)&pEndpointVolume))) {
-        pEndpointVolume->SetMasterVolumeLevelScalar(level, nullptr);
+        SUCCEEDED(pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice))) {
+        found = true;
     }
 
-    if (pEndpointVolume) pEndpointVolume->Release();
     if (pDevice) pDevice->Release();
     if (pEnumerator) pEnumerator->Release();
+    return found;
+}
+#endif
+
+static const Capabilities& capabilities() {
+    static std::once_flag probed;
+    static Capabilities caps;
+
+    std::call_once(probed, [] {
+#ifdef _WIN32
+        caps.volume = probeAudioEndpoint();
+        caps.brightness = probeWmiBrightness();
+        caps.power = true;
 #else
-    std::string cmd = "pactl set-sink-volume @DEFAULT_SINK@ " + std::to_string(level*((float)100.0)) + "%";
-    system(cmd.c_str());
+        caps.volume = probe::has_executable("pactl");
+        caps.brightness = probe::has_executable("brightnessctl") && probe::dir_has_entries("/sys/class/backlight");
+        caps.power = probe::has_executable("systemctl") && probe::has_executable("loginctl");
 #endif
+    });
+    return caps;
 }
 
-DEVICECONTROL_API void mute(bool shouldMute) {
-#ifdef _WIN32
-    ComInitializer comInit;
+// Report which device features are usable on this machine
+DEVICECONTROL_API const char* getCapabilities() {
+    TRACE_SCOPE("getCapabilities", "export");
+    static std::string result_json;
+    static std::mutex result_mutex;
 
-    IMMDeviceEnumerator* pEnumerator = nullptr;
-    IMMDevice* pDevice = nullptr;
-    IAudioEndpointVolume* pEndpointVolume = nullptr;
+    std::lock_guard<std::mutex> lock(result_mutex);
+    const Capabilities& caps = capabilities();
 
-    if (SUCCEEDED(CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
-                                   __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator)) &&
-        SUCCEEDED(pEnumerator->GetDefaultAudioEndpoint(eRender, eConsole, &pDevice)) &&
-        SUCCEEDED(pDevice->Activate(__uuidof(IAudioEndpointVolume), CLSCTX_ALL, nullptr, (void**)&pEndpointVolume))) {
-        pEndpointVolume->SetMute(shouldMute, nullptr);
-    }
+    auto flag = [](bool value) { return value ? "true" : "false"; };
+    result_json = std::string("{\"volume\":") + flag(caps.volume) +
+                  ",\"brightness\":" + flag(caps.brightness) +
+                  ",\"power\":" + flag(caps.power) + "}";
+    return result_json.c_str();
+}
 
-    if (pEndpointVolume) pEndpointVolume->Release();
-    if (pDevice) pDevice->Release();
-    if (pEnumerator) pEnumerator->Release();
-#else
-    std::string cmd = std::string("pactl set-sink-mute @DEFAULT_SINK@ toggle");
-    system(cmd.c_str());
-#endif
+// === VOLUME ===
+// Volume and brightness live in device_backend, on the shared reactor thread
+DEVICECONTROL_API float getVolume() {
+    TRACE_SCOPE("getVolume", "export");
+    return device_backend::get_volume();
+}
+
+DEVICECONTROL_API bool volume(float level) {
+    TRACE_SCOPE("volume", "export");
+    return device_backend::set_volume(level);
+}
+
+DEVICECONTROL_API bool mute(bool shouldMute) {
+    TRACE_SCOPE("mute", "export");
+    return device_backend::set_mute(shouldMute);
 }
 
 // === BRIGHTNESS ===
 DEVICECONTROL_API int getBrightness() {
-#ifdef _WIN32
-    // Use PowerShell to get current brightness
-    FILE* pipe = _popen("powershell.exe -Command \"(Get-WmiObject -Namespace root\\wmi -Class WmiMonitorBrightness).CurrentBrightness\"", "r");
-    if (!pipe) return 50;
-    char buffer[128];
-    if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        _pclose(pipe);
-        return std::stoi(buffer);
-    }
-    _pclose(pipe);
-    return 50;
-#else
-    // Parse brightnessctl output
-    FILE* pipe = popen("brightnessctl -m | cut -d',' -f4 | tr -d '%'", "r");
-    if (!pipe) return 50;
-    char buffer[128];
-    if (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        pclose(pipe);
-        return std::stoi(buffer);
-    }
-    pclose(pipe);
-    return 50;
-#endif
+    TRACE_SCOPE("getBrightness", "export");
+    return device_backend::get_brightness();
 }
 
-DEVICECONTROL_API void brightness(int level) {
-#ifdef _WIN32
-    std::wstring command = L"powershell.exe -Command \"(Get-WmiObject -Namespace root\\wmi -Class WmiMonitorBrightnessMethods).WmiSetBrightness(0," + std::to_wstring(level) + L")\"";
-    int result = (int)ShellExecuteW(nullptr, L"open", L"powershell.exe", command.c_str(), nullptr, SW_HIDE);
-    if (result <= 32)
-    {
-        std::cout << "Failed to execute PowerShell command. Error code: " << result << std::endl;
-        return;
-    }
-#else
-    std::string cmd = "brightnessctl set " + std::to_string(level) + "%";
-    system(cmd.c_str());
-#endif
+DEVICECONTROL_API bool brightness(int level) {
+    TRACE_SCOPE("brightness", "export");
+    return device_backend::set_brightness(level);
 }
 
 // === SYSTEM COMMANDS ===
-DEVICECONTROL_API void lock() {
+// sleep() and shutdown() share their names with the POSIX functions declared in
+// <unistd.h> and <sys/socket.h>, so this file must never see those headers, not
+// even indirectly through <atomic>, <thread> or <future>. Anything that needs
+// them (process probing, the volume/brightness backends, the scene runner)
+// lives in its own translation unit behind a header that includes only the
+// standard library, and trace.hpp reads its flag with compiler intrinsics.
+//
+// Each returns whether the request was accepted (a zero exit status for the
+// commands run through system()).
+DEVICECONTROL_API bool lock() {
+    TRACE_SCOPE("lock", "export");
 #ifdef _WIN32
-    LockWorkStation();
+    return LockWorkStation() != FALSE;
 #else
-    system("loginctl lock-session");
+    return system("loginctl lock-session") == 0;
 #endif
 }
 
-DEVICECONTROL_API void sleep() {
+DEVICECONTROL_API bool sleep() {
+    TRACE_SCOPE("sleep", "export");
 #ifdef _WIN32
-    SetSuspendState(FALSE, TRUE, FALSE);
+    return SetSuspendState(FALSE, TRUE, FALSE) != FALSE;
 #else
-    system("systemctl suspend");
+    return system("systemctl suspend") == 0;
 #endif
 }
 
-DEVICECONTROL_API void shutdown() {
+DEVICECONTROL_API bool shutdown() {
+    TRACE_SCOPE("shutdown", "export");
 #ifdef _WIN32
-    system("shutdown /s /t 0");
+    return system("shutdown /s /t 0") == 0;
 #else
-    system("shutdown now");
+    return system("shutdown now") == 0;
 #endif
 }
 
-DEVICECONTROL_API void restart() {
+DEVICECONTROL_API bool restart() {
+    TRACE_SCOPE("restart", "export");
 #ifdef _WIN32
-    system("shutdown /r /t 0");
+    return system("shutdown /r /t 0") == 0;
 #else
-    system("reboot");
+    return system("reboot") == 0;
 #endif
 }
+
+// === SCENES ===
+// Apply a JSON list of device and media operations in one call (see scene.hpp)
+DEVICECONTROL_API const char* runScene(const char* ops_json) {
+    TRACE_SCOPE("runScene", "export");
+    static std::string result_json;
+    static std::mutex result_mutex;
+
+    static const scene::DeviceBackend backend {
+        volume,
+        mute,
+        brightness,
+        lock,
+        sleep,
+        shutdown,
+        restart,
+    };
+
+    std::string result = scene::run(ops_json, backend);
+
+    std::lock_guard<std::mutex> guard(result_mutex);
+    result_json = std::move(result);
+    return result_json.c_str();
+}
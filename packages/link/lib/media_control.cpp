@@ -1,13 +1,19 @@
 #include <iostream>
 #include <string>
 #include <chrono>
-#include <future>
 #include <mutex>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <cstdint>
 #include <string>
 #include <vector>
+#include "palette.hpp"
+#include "playback_log.hpp"
+#include "playback_position.hpp"
+#include "probe.hpp"
+#include "reactor.hpp"
+#include "session.hpp"
+#include "trace.hpp"
 
 using json = nlohmann::json;
 
@@ -16,11 +22,14 @@ using json = nlohmann::json;
     #define PLATFORM_WINDOWS true
     #include <windows.h>
     #include <winrt/Windows.Foundation.h>
+    #include <winrt/Windows.Foundation.Metadata.h>
+    #include <winrt/Windows.Graphics.Imaging.h>
     #include <winrt/Windows.Media.Control.h>
     #include <winrt/Windows.Storage.Streams.h>
     using namespace winrt;
     using namespace Windows::Media::Control;
     using namespace Windows::Foundation;
+    using namespace Windows::Graphics::Imaging;
     using namespace Windows::Storage::Streams;
     #define EXPORT_API __declspec(dllexport)
 #else
@@ -31,6 +40,7 @@ using json = nlohmann::json;
     #include <stdexcept>
     #include <string>
     #include <sstream>
+    #include <tuple>
     #define EXPORT_API __attribute__((visibility("default")))
 #endif
 
@@ -60,6 +70,7 @@ std::string base64_encode(const std::vector<uint8_t>& data) {
 struct ArtworkCache {
     std::string trackKey;      // title + artist combined
     std::string base64Data;    // cached base64 artwork
+    json palette;              // colors of the cached artwork, null if none
     bool sentForCurrentTrack;  // whether we've sent artwork for this track
     std::mutex mutex;
     
@@ -68,6 +79,28 @@ struct ArtworkCache {
 
 static ArtworkCache g_artworkCache;
 
+#ifdef PLATFORM_WINDOWS
+// Artwork palettes by track key, so returning to a track skips decoding
+static palette::Cache g_paletteCache;
+
+// Palette as sent with track info; null when the artwork had no opaque pixels
+static json palette_json(const palette::Palette& colors) {
+    if (colors.colors.empty()) return nullptr;
+
+    json result;
+    result["dominant"] = palette::to_hex(colors.colors[colors.dominant]);
+    result["accent"] = palette::to_hex(colors.colors[colors.accent]);
+    result["colors"] = json::array();
+    for (const auto& color : colors.colors) {
+        result["colors"].push_back({{"color", palette::to_hex(color)}, {"weight", color.weight}});
+    }
+    return result;
+}
+#endif
+
+// Listening history, appended on track/status transitions seen while polling
+static playback_log::PlaybackLog g_playbackLog;
+
 // Format duration from seconds to mm:ss format
 std::string format_duration(double seconds) {
     if (seconds < 0) {
@@ -87,95 +120,113 @@ std::string format_duration(double seconds) {
 }
 
 #ifdef PLATFORM_WINDOWS
-// Track position tracker class for Windows
+// Feeds the GSMTC timeline into the playback position estimate
 class TrackPositionTracker {
 public:
-    TrackPositionTracker()
-        : start_time(std::chrono::system_clock::now()),
-          initial_position(0),
-          old_position(0),
-          total_duration(0),
-          last_playback_state(""),
-          paused_position(0),
-          start_time_initialized(false) {}
-
     std::pair<double, double> update_from_timeline(const GlobalSystemMediaTransportControlsSessionTimelineProperties& timeline, const std::string& playback_status) {
-        auto current_time = std::chrono::system_clock::now();
-        double position = 0;
-        
-        if (timeline.Position().count() != 0) {
-            position = timeline.Position().count() / 10000000.0; // Convert 100-nanosecond units to seconds
-        } else {
-            return {0, total_duration};
+        if (timeline.Position().count() == 0) {
+            return {0, tracker.duration()};
         }
 
-        // Update total duration if available
-        if (timeline.EndTime().count() != 0) {
-            total_duration = timeline.EndTime().count() / 10000000.0;
-        }
+        // Convert 100-nanosecond units to seconds
+        double position = timeline.Position().count() / 10000000.0;
+        double duration = timeline.EndTime().count() / 10000000.0;
+        return tracker.update(position, duration, playback_status == "Playing", std::chrono::steady_clock::now());
+    }
+
+private:
+    playback_position::Tracker tracker;
+};
+
+// Global tracker instance for Windows
+static TrackPositionTracker global_tracker;
+
+// Decode a thumbnail straight to a small BGRA sample (the decoder does the
+// downscaling) and extract its palette
+static palette::Palette decode_palette(const IRandomAccessStream& stream) {
+    TRACE_SCOPE("palette", "artwork");
+    stream.Seek(0);
+    auto decoder = BitmapDecoder::CreateAsync(stream).get();
+
+    const uint32_t width = decoder.OrientedPixelWidth();
+    const uint32_t height = decoder.OrientedPixelHeight();
+    if (width == 0 || height == 0) return {};
+
+    const double scale = std::min(1.0, static_cast<double>(palette::kSampleEdge) / std::max(width, height));
+    const uint32_t sample_width = std::max<uint32_t>(1, static_cast<uint32_t>(width * scale));
+    const uint32_t sample_height = std::max<uint32_t>(1, static_cast<uint32_t>(height * scale));
+
+    BitmapTransform transform;
+    transform.ScaledWidth(sample_width);
+    transform.ScaledHeight(sample_height);
+    transform.InterpolationMode(BitmapInterpolationMode::Linear);
 
-        // Check playback status
-        bool is_playing = (playback_status == "Playing");
-        bool was_playing = (last_playback_state == "Playing");
-
-        // First initialization
-        if (!start_time_initialized) {
-            start_time = current_time;
-            initial_position = position;
-            old_position = position;
-            last_playback_state = playback_status;
-            start_time_initialized = true;
-            return {position, total_duration};
+    auto provider = decoder.GetPixelDataAsync(BitmapPixelFormat::Bgra8, BitmapAlphaMode::Straight, transform,
+                                              ExifOrientationMode::RespectExifOrientation,
+                                              ColorManagementMode::DoNotColorManage).get();
+    auto pixels = provider.DetachPixelData();
+    if (pixels.size() < static_cast<size_t>(sample_width) * sample_height * 4) return {};
+
+    return palette::extract(pixels.data(), sample_width, sample_height, sample_width * 4);
+}
+
+// Media session manager, requested on the reactor thread (which is in the MTA, so
+// blocking on async results is safe there) and reused by every export once it
+// has been obtained. A failed request (e.g. at login, before the shell's media
+// service is up) is retried on the next call. The manager is agile so it can be
+// shared across the threads bun calls us on.
+class MediaSessionBackend {
+public:
+    GlobalSystemMediaTransportControlsSessionManager manager() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (session_manager) return session_manager;
         }
 
-        // Handle state changes
-        if (is_playing && !was_playing) {
-            // Resuming playback
-            start_time = current_time;
-            initial_position = (paused_position > 0) ? paused_position : position;
-        } else if (!is_playing && was_playing) {
-            // Just paused
-            auto paused_at = current_time;
-            double elapsed = std::chrono::duration<double>(paused_at - start_time).count();
-            paused_position = initial_position + elapsed;
+        // Not held across the request: the reactor thread itself calls in here
+        GlobalSystemMediaTransportControlsSessionManager requested{nullptr};
+        try {
+            requested = reactor::call([] {
+                TRACE_SCOPE("RequestAsync", "winrt");
+                return GlobalSystemMediaTransportControlsSessionManager::RequestAsync().get();
+            });
+        } catch (const std::exception& ex) {
+            std::cerr << "Error requesting media session manager: " << ex.what() << std::endl;
+        } catch (const winrt::hresult_error& ex) {
+            std::cerr << "Error requesting media session manager: " << winrt::to_string(ex.message()) << std::endl;
         }
 
-        last_playback_state = playback_status;
-
-        // Calculate current position
-        if (is_playing) {
-            double elapsed = 1.0;
-            if (old_position == position) {
-                // No change in position, return last known position
-                initial_position = initial_position + elapsed;
-            } else {
-                initial_position = position + 1.0;
-                old_position = position;
-            }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!session_manager) session_manager = requested;
+        return session_manager;
+    }
 
-            return {std::min(initial_position, total_duration), total_duration};
-        } else {
-            // Return last known position when paused
-            return {(paused_position > 0) ? paused_position : position, total_duration};
-        }
+    GlobalSystemMediaTransportControlsSession current_session() {
+        auto session_manager = manager();
+        return session_manager ? session_manager.GetCurrentSession() : nullptr;
+    }
+
+    // Whether this Windows build has the media session API. Capabilities use this
+    // rather than a manager request, which can fail transiently (see above) and
+    // would hide media support until the link reconnects.
+    bool supported() {
+        static const bool present = reactor::call([] {
+            return Metadata::ApiInformation::IsTypePresent(
+                L"Windows.Media.Control.GlobalSystemMediaTransportControlsSessionManager");
+        });
+        return present;
     }
 
 private:
-    std::chrono::system_clock::time_point start_time;
-    double initial_position;
-    double old_position;
-    double total_duration;
-    std::string last_playback_state;
-    std::chrono::system_clock::time_point paused_at;
-    double paused_position;
-    bool start_time_initialized;
+    std::mutex mutex;
+    GlobalSystemMediaTransportControlsSessionManager session_manager{nullptr};
 };
 
-// Global tracker instance for Windows
-static TrackPositionTracker global_tracker;
+static MediaSessionBackend g_mediaBackend;
 #else
 // Unix utility to execute commands and get output
 std::string exec(const char* cmd) {
+    TRACE_SCOPE("popen", "spawn");
     std::array<char, 128> buffer;
     std::string result;
     std::unique_ptr<FILE, decltype(&pclose)> pipe(popen(cmd, "r"), pclose);
@@ -226,17 +277,169 @@ public:
 
 // Global tracker instance for Unix
 static UnixTrackPositionTracker unix_tracker;
+
+// Player state pushed by `playerctl --follow` on the reactor thread. While the
+// follower is running, track info is served from here without spawning anything,
+// and a follower that has said nothing means no player is running. The exec path
+// above is only used while the follower is not running (it could not be started
+// or is waiting to be restarted) and for a moment after it starts, before it has
+// had a chance to report the current player.
+class PlayerctlWatcher {
+public:
+    struct State {
+        bool present = false;
+        std::string status;
+        std::string title;
+        std::string artist;
+        std::string artwork;
+        double position = 0;
+        double length = 0;
+    };
+
+    void start() {
+        std::call_once(started, [this] {
+            reactor::follow_process(
+                {"playerctl", "--follow", "metadata", "--format",
+                 "{{status}}\t{{title}}\t{{artist}}\t{{mpris:artUrl}}\t{{position}}\t{{mpris:length}}"},
+                [this](const std::string& line) { on_line(line); },
+                [this] { on_exit(); },
+                kRestartMs,
+                [this] { on_start(); });
+
+            // Metadata events do not carry playback progress; resync it now and
+            // then while playing so extrapolation does not drift
+            reactor::add_timer(kResyncMs, [this] { resync_position(); });
+        });
+    }
+
+    // Current state with the position extrapolated while playing. Returns false
+    // when the follower is not running or has only just started.
+    bool snapshot(State& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return false;
+        if (!reported && Clock::now() - started_at < std::chrono::milliseconds(kSettleMs)) return false;
+
+        out = state;
+        if (state.present && state.status == "Playing") {
+            out.position += std::chrono::duration<double>(Clock::now() - updated_at).count();
+            if (out.length > 0 && out.position > out.length) out.position = out.length;
+        }
+        return true;
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t kResyncMs = 5000;
+    static constexpr uint32_t kRestartMs = 5000;
+    // playerctl prints the current player right after it starts; silence after
+    // this long means there is none
+    static constexpr uint32_t kSettleMs = 500;
+
+    static double micros_to_seconds(const std::string& field) {
+        try {
+            return field.empty() ? 0.0 : std::stod(field) / 1000000.0;
+        } catch (const std::exception&) {
+            return 0.0;
+        }
+    }
+
+    void on_line(const std::string& line) {
+        State next;
+        if (!line.empty()) {
+            std::vector<std::string> fields;
+            std::stringstream stream(line);
+            std::string field;
+            while (std::getline(stream, field, '\t')) fields.push_back(field);
+            fields.resize(6);
+
+            next.present = true;
+            next.status = fields[0];
+            next.title = fields[1];
+            next.artist = fields[2];
+            next.artwork = fields[3];
+            next.position = micros_to_seconds(fields[4]);
+            next.length = micros_to_seconds(fields[5]);
+        }
+
+        // Players appearing or starting are noticed here rather than on the
+        // next (possibly backed-off) track poll
+        session::note_player(next.present, next.status == "Playing");
+
+        std::lock_guard<std::mutex> lock(mutex);
+        state = next;
+        updated_at = Clock::now();
+        reported = true;
+    }
+
+    void on_start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        state = State{};
+        started_at = Clock::now();
+        updated_at = started_at;
+        running = true;
+        reported = false;
+    }
+
+    void on_exit() {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+
+    // Runs on the reactor thread; the position arrives once playerctl exits
+    void resync_position() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running || !state.present || state.status != "Playing") return;
+        }
+
+        reactor::capture({"playerctl", "position"}, [this](int code, const std::string& output) {
+            if (code != 0) return;  // Player went away between events; the follower will report it
+            try {
+                double position = std::stod(output);
+
+                std::lock_guard<std::mutex> lock(mutex);
+                state.position = position;
+                updated_at = Clock::now();
+            } catch (const std::exception&) {
+                // Not a number: leave the extrapolated position alone
+            }
+        });
+    }
+
+    std::once_flag started;
+    std::mutex mutex;
+    State state;
+    Clock::time_point updated_at;
+    Clock::time_point started_at;
+    bool running = false;
+    bool reported = false;
+};
+
+static PlayerctlWatcher g_playerWatcher;
+
+// Whether playerctl can be used, resolved on first use instead of at load time
+static bool playerctl_available() {
+    static const bool available = [] {
+        bool found = probe::has_executable("playerctl");
+        if (!found) {
+            std::cerr << "Warning: playerctl is not installed. Media control functions will not work.\n";
+            std::cerr << "Please install playerctl using your package manager (e.g., 'sudo apt install playerctl').\n";
+        }
+        return found;
+    }();
+    return available;
+}
 #endif
 
 // FFI Exports
 extern "C" {
     // Play media
     EXPORT_API bool playMedia() {
+        TRACE_SCOPE("playMedia", "export");
 #ifdef PLATFORM_WINDOWS
         try {
             auto play_async = []() -> fire_and_forget {
-                auto manager = co_await GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                auto current_session = manager.GetCurrentSession();
+                auto current_session = g_mediaBackend.current_session();
                 
                 if (current_session) {
                     co_await current_session.TryPlayAsync();
@@ -250,9 +453,9 @@ extern "C" {
             return false;
         }
 #else
+        if (!playerctl_available()) return false;
         try {
-            int result = system("playerctl play");
-            return (result == 0);
+            return reactor::run({"playerctl", "play"}) == 0;
         } catch (const std::exception& ex) {
             std::cerr << "Error in playMedia: " << ex.what() << std::endl;
             return false;
@@ -262,11 +465,11 @@ extern "C" {
     
     // Pause media
     EXPORT_API bool pauseMedia() {
+        TRACE_SCOPE("pauseMedia", "export");
 #ifdef PLATFORM_WINDOWS
         try {
             auto pause_async = []() -> fire_and_forget {
-                auto manager = co_await GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                auto current_session = manager.GetCurrentSession();
+                auto current_session = g_mediaBackend.current_session();
                 
                 if (current_session) {
                     co_await current_session.TryPauseAsync();
@@ -280,9 +483,9 @@ extern "C" {
             return false;
         }
 #else
+        if (!playerctl_available()) return false;
         try {
-            int result = system("playerctl pause");
-            return (result == 0);
+            return reactor::run({"playerctl", "pause"}) == 0;
         } catch (const std::exception& ex) {
             std::cerr << "Error in pauseMedia: " << ex.what() << std::endl;
             return false;
@@ -292,11 +495,11 @@ extern "C" {
     
     // Next track
     EXPORT_API bool nextTrack() {
+        TRACE_SCOPE("nextTrack", "export");
 #ifdef PLATFORM_WINDOWS
         try {
             auto next_async = []() -> fire_and_forget {
-                auto manager = co_await GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                auto current_session = manager.GetCurrentSession();
+                auto current_session = g_mediaBackend.current_session();
                 
                 if (current_session) {
                     co_await current_session.TrySkipNextAsync();
@@ -310,9 +513,9 @@ extern "C" {
             return false;
         }
 #else
+        if (!playerctl_available()) return false;
         try {
-            int result = system("playerctl next");
-            return (result == 0);
+            return reactor::run({"playerctl", "next"}) == 0;
         } catch (const std::exception& ex) {
             std::cerr << "Error in nextTrack: " << ex.what() << std::endl;
             return false;
@@ -322,11 +525,11 @@ extern "C" {
     
     // Previous track
     EXPORT_API bool previousTrack() {
+        TRACE_SCOPE("previousTrack", "export");
 #ifdef PLATFORM_WINDOWS
         try {
             auto prev_async = []() -> fire_and_forget {
-                auto manager = co_await GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                auto current_session = manager.GetCurrentSession();
+                auto current_session = g_mediaBackend.current_session();
                 
                 if (current_session) {
                     co_await current_session.TrySkipPreviousAsync();
@@ -340,9 +543,9 @@ extern "C" {
             return false;
         }
 #else
+        if (!playerctl_available()) return false;
         try {
-            int result = system("playerctl previous");
-            return (result == 0);
+            return reactor::run({"playerctl", "previous"}) == 0;
         } catch (const std::exception& ex) {
             std::cerr << "Error in previousTrack: " << ex.what() << std::endl;
             return false;
@@ -352,6 +555,7 @@ extern "C" {
     
     // Seek to position
     EXPORT_API bool seekTo(const char* position_cstr) {
+        TRACE_SCOPE("seekTo", "export");
 #ifdef PLATFORM_WINDOWS
         try {
             auto seek_async = [position_cstr]() -> fire_and_forget {
@@ -359,8 +563,7 @@ extern "C" {
                     std::string position_str(position_cstr);  // Now happens inside lambda
                     int64_t pos = std::stoll(position_str) * 10000000;
     
-                    auto manager = co_await GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                    auto current_session = manager.GetCurrentSession();
+                    auto current_session = g_mediaBackend.current_session();
     
                     if (current_session) {
                         auto timeline = current_session.GetTimelineProperties();
@@ -393,12 +596,11 @@ extern "C" {
             return false;
         }
 #else
+        if (!playerctl_available()) return false;
         try {
             std::string position_sec(position_cstr);
-            std::string cmd = "playerctl position " + position_sec;
-            std::cerr << "Executing command: " << cmd << std::endl;
-            int result = system(cmd.c_str());
-            return (result == 0);
+            std::cerr << "Seeking to: " << position_sec << " seconds" << std::endl;
+            return reactor::run({"playerctl", "position", position_sec}) == 0;
         } catch (const std::exception& ex) {
             std::cerr << "Error in seekTo: " << ex.what() << std::endl;
             return false;
@@ -408,34 +610,41 @@ extern "C" {
         
     // Get current track info
     EXPORT_API const char* getCurrentTrackInfo() {
+        TRACE_SCOPE("getCurrentTrackInfo", "export");
         static std::string result_json;
         static std::mutex result_mutex;
         
         try {
 #ifdef PLATFORM_WINDOWS
-            // Create a future to handle the async operation
-            auto get_info = std::async(std::launch::async, []() -> json {
+            // Blocking WinRT calls run on the reactor thread
+            json track_info = reactor::call([]() -> json {
                 try {
-                    winrt::init_apartment();
-                    
-                    // Get the media session
-                    auto manager_task = GlobalSystemMediaTransportControlsSessionManager::RequestAsync();
-                    auto manager = manager_task.get();
-                    auto current_session = manager.GetCurrentSession();
+                    // Reuse the cached session manager
+                    auto current_session = g_mediaBackend.current_session();
                     
                     if (!current_session) {
+                        g_playbackLog.observe("", "", "Closed", 0);
+                        session::note_player(false, false);
                         json error;
                         error["error"] = "No media is currently playing";
                         return error;
                     }
                     
                     // Get media properties
-                    auto info_task = current_session.TryGetMediaPropertiesAsync();
-                    auto info = info_task.get();
+                    GlobalSystemMediaTransportControlsSessionMediaProperties info{nullptr};
+                    {
+                        TRACE_SCOPE("TryGetMediaPropertiesAsync", "winrt");
+                        info = current_session.TryGetMediaPropertiesAsync().get();
+                    }
                     
                     // Get timeline and playback info
-                    auto timeline = current_session.GetTimelineProperties();
-                    auto playback_info = current_session.GetPlaybackInfo();
+                    GlobalSystemMediaTransportControlsSessionTimelineProperties timeline{nullptr};
+                    GlobalSystemMediaTransportControlsSessionPlaybackInfo playback_info{nullptr};
+                    {
+                        TRACE_SCOPE("GetTimelineProperties", "winrt");
+                        timeline = current_session.GetTimelineProperties();
+                        playback_info = current_session.GetPlaybackInfo();
+                    }
                     std::string playback_status;
                     
                     // Convert playback status enum to string
@@ -468,6 +677,9 @@ extern "C" {
                     std::string artist = winrt::to_string(info.Artist());
                     std::string trackKey = title + "|" + artist;
                     
+                    g_playbackLog.observe(title, artist, playback_status, current_position);
+                    session::note_player(true, playback_status == "Playing");
+                    
                     // Create result JSON
                     json result;
                     result["title"] = title;
@@ -485,8 +697,10 @@ extern "C" {
                         // If stopped or closed, send null and clear cache
                         if (playback_status == "Stopped" || playback_status == "Closed") {
                             result["artwork"] = nullptr;
+                            result["palette"] = nullptr;
                             g_artworkCache.trackKey = "";
                             g_artworkCache.base64Data = "";
+                            g_artworkCache.palette = nullptr;
                             g_artworkCache.sentForCurrentTrack = false;
                         }
                         // Check if track changed
@@ -495,8 +709,10 @@ extern "C" {
                             g_artworkCache.trackKey = trackKey;
                             g_artworkCache.sentForCurrentTrack = false;
                             g_artworkCache.base64Data = "";
+                            g_artworkCache.palette = nullptr;
                             
                             try {
+                                TRACE_SCOPE("thumbnail", "artwork");
                                 auto thumbnail = info.Thumbnail();
                                 if (thumbnail) {
                                     // Open the stream and read the thumbnail
@@ -516,7 +732,22 @@ extern "C" {
                                         if (contentType.empty()) contentType = "image/png";
                                         
                                         // Encode to base64 data URL
-                                        g_artworkCache.base64Data = "data:" + contentType + ";base64," + base64_encode(imageData);
+                                        {
+                                            TRACE_SCOPE("base64", "encode");
+                                            g_artworkCache.base64Data = "data:" + contentType + ";base64," + base64_encode(imageData);
+                                        }
+
+                                        // Palette from the same thumbnail, decoded once per track
+                                        palette::Palette colors;
+                                        if (!g_paletteCache.find(trackKey, colors)) {
+                                            try {
+                                                colors = decode_palette(streamRef);
+                                                g_paletteCache.put(trackKey, colors);
+                                            } catch (...) {
+                                                // Undecodable artwork, no palette for this track
+                                            }
+                                        }
+                                        g_artworkCache.palette = palette_json(colors);
                                     }
                                     streamRef.Close();
                                 }
@@ -535,6 +766,11 @@ extern "C" {
                         }
                         // Same track - don't include artwork field (omit it entirely)
                         // The client should keep showing the last received artwork
+
+                        // The palette is small, so it rides along with every update
+                        if (!result.contains("palette")) {
+                            result["palette"] = g_artworkCache.palette;
+                        }
                     }
                     
                     return result;
@@ -544,27 +780,51 @@ extern "C" {
                     return error;
                 }
             });
-            
-            // Get the result from the future
-            json track_info = get_info.get();
 #else
-			std::string player_status = exec("playerctl status");
-			if (player_status.empty() || player_status == "No players found") {
-				json error;
-				error["error"] = "No media is currently playing";
-				return error.dump().c_str();
-			}
-
             json track_info;
             try {
-                // Get track info using playerctl
-                std::string title = exec("playerctl metadata title");
-                std::string artist = exec("playerctl metadata artist");
-                std::string status = exec("playerctl status");
-                std::string artwork = exec("playerctl metadata mpris:artUrl");
+                if (!playerctl_available()) {
+                    throw std::runtime_error("playerctl is not installed");
+                }
+
+                g_playerWatcher.start();
+
+                std::string title, artist, status, artwork;
+                double position = 0, duration = 0;
+
+                PlayerctlWatcher::State state;
+                if (g_playerWatcher.snapshot(state)) {
+                    if (!state.present) {
+                        g_playbackLog.observe("", "", "Closed", 0);
+                        session::note_player(false, false);
+                        throw std::runtime_error("No media is currently playing");
+                    }
+                    title = state.title;
+                    artist = state.artist;
+                    status = state.status;
+                    artwork = state.artwork;
+                    position = state.position;
+                    duration = state.length;
+                } else {
+                    std::string player_status = exec("playerctl status");
+                    if (player_status.empty() || player_status == "No players found") {
+                        g_playbackLog.observe("", "", "Closed", 0);
+                        session::note_player(false, false);
+                        throw std::runtime_error("No media is currently playing");
+                    }
+
+                    // Get track info using playerctl
+                    title = exec("playerctl metadata title");
+                    artist = exec("playerctl metadata artist");
+                    status = player_status;
+                    artwork = exec("playerctl metadata mpris:artUrl");
+
+                    // Get position and duration
+                    std::tie(position, duration) = unix_tracker.getCurrentPosition();
+                }
                 
-                // Get position and duration
-                auto [position, duration] = unix_tracker.getCurrentPosition();
+                g_playbackLog.observe(title, artist, status, position);
+                session::note_player(true, status == "Playing");
                 
                 // Create result JSON
                 track_info["title"] = title;
@@ -587,6 +847,7 @@ extern "C" {
             // Lock the mutex and update the result string
             {
                 std::lock_guard<std::mutex> lock(result_mutex);
+                TRACE_SCOPE("dump", "json");
                 result_json = track_info.dump();
             }
             
@@ -600,6 +861,91 @@ extern "C" {
             return result_json.c_str();
         }
     }
+
+    // Open (or create) the memory-mapped playback history ring at the given path
+    EXPORT_API bool openPlaybackLog(const char* path_cstr) {
+        TRACE_SCOPE("openPlaybackLog", "export");
+        try {
+            if (!path_cstr) return false;
+            return g_playbackLog.open(path_cstr);
+        } catch (const std::exception& ex) {
+            std::cerr << "Error in openPlaybackLog: " << ex.what() << std::endl;
+            return false;
+        }
+    }
+
+    // Report which media features are usable on this machine
+    EXPORT_API const char* getCapabilities() {
+        TRACE_SCOPE("getCapabilities", "export");
+        static std::string result_json;
+        static std::mutex result_mutex;
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        try {
+            json capabilities;
+#ifdef PLATFORM_WINDOWS
+            capabilities["media"] = g_mediaBackend.supported();
+            capabilities["backend"] = "gsmtc";
+            capabilities["palette"] = true;
+#else
+            capabilities["media"] = playerctl_available();
+            capabilities["backend"] = "playerctl";
+            capabilities["palette"] = false;
+#endif
+            capabilities["playbackLog"] = g_playbackLog.is_open();
+            result_json = capabilities.dump();
+        } catch (const std::exception& ex) {
+            json error;
+            error["error"] = ex.what();
+            result_json = error.dump();
+        }
+        return result_json.c_str();
+    }
+
+    // Session state and the polling intervals the link should use right now
+    EXPORT_API const char* getPollingHints() {
+        TRACE_SCOPE("getPollingHints", "export");
+        static std::string result_json;
+        static std::mutex result_mutex;
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        try {
+            session::Hints hints = session::hints();
+
+            json result;
+            result["locked"] = hints.locked;
+            result["idle"] = hints.idle;
+            result["idle_seconds"] = hints.idleSeconds;
+            result["player"] = hints.player;
+            result["playing"] = hints.playing;
+            result["media_ms"] = hints.mediaMs;
+            result["device_ms"] = hints.deviceMs;
+            result["heartbeat_ms"] = hints.heartbeatMs;
+            result_json = result.dump();
+        } catch (const std::exception& ex) {
+            json error;
+            error["error"] = ex.what();
+            result_json = error.dump();
+        }
+        return result_json.c_str();
+    }
+
+    // Read up to max_records history records starting at cursor
+    EXPORT_API const char* readPlaybackHistory(uint64_t cursor, uint32_t max_records) {
+        TRACE_SCOPE("readPlaybackHistory", "export");
+        static std::string result_json;
+        static std::mutex result_mutex;
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        try {
+            result_json = g_playbackLog.read(cursor, max_records).dump();
+        } catch (const std::exception& ex) {
+            json error;
+            error["error"] = ex.what();
+            result_json = error.dump();
+        }
+        return result_json.c_str();
+    }
 }
 
 #ifdef PLATFORM_WINDOWS
@@ -607,35 +953,17 @@ extern "C" {
 BOOL APIENTRY DllMain(HMODULE hModule, DWORD ul_reason_for_call, LPVOID lpReserved) {
     switch (ul_reason_for_call) {
     case DLL_PROCESS_ATTACH:
-        // Initialize WinRT
-        winrt::init_apartment();
+        // WinRT is initialized lazily by the first export that needs it;
+        // nothing here may block under the loader lock
+        DisableThreadLibraryCalls(hModule);
         break;
     case DLL_THREAD_ATTACH:
         break;
     case DLL_THREAD_DETACH:
         break;
     case DLL_PROCESS_DETACH:
-        // Uninitialize WinRT
-        winrt::uninit_apartment();
         break;
     }
     return TRUE;
 }
-#else
-// Library initialization for Unix
-__attribute__((constructor))
-static void initialize() {
-    // Check if playerctl is installed
-    int result = system("which playerctl > /dev/null 2>&1");
-    if (result != 0) {
-        std::cerr << "Warning: playerctl is not installed. Media control functions will not work.\n";
-        std::cerr << "Please install playerctl using your package manager (e.g., 'sudo apt install playerctl').\n";
-    }
-}
-
-// Library cleanup for Unix
-__attribute__((destructor))
-static void cleanup() {
-    // Any cleanup needed
-}
 #endif
\ No newline at end of file
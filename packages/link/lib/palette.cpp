@@ -0,0 +1,269 @@
+#include "palette.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PALETTE_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define PALETTE_NEON 1
+#endif
+
+namespace palette {
+namespace {
+
+constexpr int kMaxIterations = 10;
+
+// Seeds closer than this (squared RGB distance) are treated as the same color
+constexpr float kMinSeedDistance = 32.0f * 32.0f;
+
+// Pixels as separate channel planes, padded to a multiple of four
+struct Samples {
+    std::vector<float> r, g, b;
+    size_t count = 0;
+};
+
+struct Centroids {
+    std::array<float, kClusters> r{}, g{}, b{};
+    size_t count = 0;
+};
+
+Samples gather(const uint8_t* bgra, uint32_t width, uint32_t height, uint32_t stride) {
+    Samples samples;
+    const size_t capacity = (static_cast<size_t>(width) * height + 3) & ~static_cast<size_t>(3);
+    samples.r.reserve(capacity);
+    samples.g.reserve(capacity);
+    samples.b.reserve(capacity);
+
+    for (uint32_t y = 0; y < height; ++y) {
+        const uint8_t* row = bgra + static_cast<size_t>(y) * stride;
+        for (uint32_t x = 0; x < width; ++x) {
+            const uint8_t* px = row + x * 4;
+            if (px[3] < 128) continue;
+            samples.b.push_back(px[0]);
+            samples.g.push_back(px[1]);
+            samples.r.push_back(px[2]);
+        }
+    }
+
+    samples.count = samples.r.size();
+    // Pad by repeating the last pixel; padded lanes are never counted
+    while (samples.count > 0 && samples.r.size() % 4 != 0) {
+        samples.r.push_back(samples.r.back());
+        samples.g.push_back(samples.g.back());
+        samples.b.push_back(samples.b.back());
+    }
+    return samples;
+}
+
+// Seed from the most populated cells of a coarse 3-bit-per-channel histogram,
+// skipping cells whose color is too close to an earlier seed. Deterministic, so
+// the same artwork always yields the same palette.
+Centroids seed(const Samples& samples) {
+    struct Cell {
+        uint32_t count = 0;
+        float r = 0, g = 0, b = 0;
+    };
+    std::array<Cell, 512> cells{};
+
+    for (size_t i = 0; i < samples.count; ++i) {
+        size_t index = (static_cast<size_t>(samples.r[i]) >> 5) << 6 |
+                       (static_cast<size_t>(samples.g[i]) >> 5) << 3 |
+                       (static_cast<size_t>(samples.b[i]) >> 5);
+        Cell& cell = cells[index];
+        ++cell.count;
+        cell.r += samples.r[i];
+        cell.g += samples.g[i];
+        cell.b += samples.b[i];
+    }
+
+    std::array<uint16_t, 512> order;
+    for (uint16_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) { return cells[a].count > cells[b].count; });
+
+    Centroids centroids;
+    for (uint16_t index : order) {
+        const Cell& cell = cells[index];
+        if (cell.count == 0 || centroids.count == kClusters) break;
+
+        const float r = cell.r / cell.count, g = cell.g / cell.count, b = cell.b / cell.count;
+        bool distinct = true;
+        for (size_t c = 0; c < centroids.count && distinct; ++c) {
+            const float dr = r - centroids.r[c], dg = g - centroids.g[c], db = b - centroids.b[c];
+            distinct = dr * dr + dg * dg + db * db >= kMinSeedDistance;
+        }
+        if (!distinct) continue;
+
+        centroids.r[centroids.count] = r;
+        centroids.g[centroids.count] = g;
+        centroids.b[centroids.count] = b;
+        ++centroids.count;
+    }
+    return centroids;
+}
+
+// Nearest centroid for every sample; returns how many assignments changed
+size_t assign(const Samples& samples, const Centroids& centroids, std::vector<int32_t>& labels) {
+    size_t changed = 0;
+    const size_t padded = samples.r.size();
+
+#if defined(PALETTE_SSE2)
+    for (size_t i = 0; i < padded; i += 4) {
+        const __m128 r = _mm_loadu_ps(&samples.r[i]);
+        const __m128 g = _mm_loadu_ps(&samples.g[i]);
+        const __m128 b = _mm_loadu_ps(&samples.b[i]);
+
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 label = _mm_setzero_ps();
+        for (size_t c = 0; c < centroids.count; ++c) {
+            const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(centroids.r[c]));
+            const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(centroids.g[c]));
+            const __m128 db = _mm_sub_ps(b, _mm_set1_ps(centroids.b[c]));
+            const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+
+            const __m128 closer = _mm_cmplt_ps(dist, best);
+            best = _mm_min_ps(dist, best);
+            label = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps(static_cast<float>(c))), _mm_andnot_ps(closer, label));
+        }
+
+        alignas(16) int32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_cvtps_epi32(label));
+        for (size_t lane = 0; lane < 4 && i + lane < samples.count; ++lane) {
+            if (labels[i + lane] != lanes[lane]) ++changed;
+            labels[i + lane] = lanes[lane];
+        }
+    }
+#elif defined(PALETTE_NEON)
+    for (size_t i = 0; i < padded; i += 4) {
+        const float32x4_t r = vld1q_f32(&samples.r[i]);
+        const float32x4_t g = vld1q_f32(&samples.g[i]);
+        const float32x4_t b = vld1q_f32(&samples.b[i]);
+
+        float32x4_t best = vdupq_n_f32(std::numeric_limits<float>::max());
+        float32x4_t label = vdupq_n_f32(0.0f);
+        for (size_t c = 0; c < centroids.count; ++c) {
+            const float32x4_t dr = vsubq_f32(r, vdupq_n_f32(centroids.r[c]));
+            const float32x4_t dg = vsubq_f32(g, vdupq_n_f32(centroids.g[c]));
+            const float32x4_t db = vsubq_f32(b, vdupq_n_f32(centroids.b[c]));
+            const float32x4_t dist = vmlaq_f32(vmlaq_f32(vmulq_f32(dr, dr), dg, dg), db, db);
+
+            const uint32x4_t closer = vcltq_f32(dist, best);
+            best = vminq_f32(dist, best);
+            label = vbslq_f32(closer, vdupq_n_f32(static_cast<float>(c)), label);
+        }
+
+        int32_t lanes[4];
+        vst1q_s32(lanes, vcvtq_s32_f32(label));
+        for (size_t lane = 0; lane < 4 && i + lane < samples.count; ++lane) {
+            if (labels[i + lane] != lanes[lane]) ++changed;
+            labels[i + lane] = lanes[lane];
+        }
+    }
+#else
+    (void)padded;
+    for (size_t i = 0; i < samples.count; ++i) {
+        float best = std::numeric_limits<float>::max();
+        int32_t label = 0;
+        for (size_t c = 0; c < centroids.count; ++c) {
+            const float dr = samples.r[i] - centroids.r[c];
+            const float dg = samples.g[i] - centroids.g[c];
+            const float db = samples.b[i] - centroids.b[c];
+            const float dist = dr * dr + dg * dg + db * db;
+            if (dist < best) {
+                best = dist;
+                label = static_cast<int32_t>(c);
+            }
+        }
+        if (labels[i] != label) ++changed;
+        labels[i] = label;
+    }
+#endif
+
+    return changed;
+}
+
+uint8_t to_channel(float value) {
+    return static_cast<uint8_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+}
+
+int chroma(const Color& color) {
+    return std::max({color.r, color.g, color.b}) - std::min({color.r, color.g, color.b});
+}
+
+} // namespace
+
+Palette extract(const uint8_t* bgra, uint32_t width, uint32_t height, uint32_t stride) {
+    Palette result;
+    if (!bgra || width == 0 || height == 0) return result;
+
+    const Samples samples = gather(bgra, width, height, stride);
+    if (samples.count == 0) return result;
+
+    Centroids centroids = seed(samples);
+    std::vector<int32_t> labels(samples.count, -1);
+    std::array<uint32_t, kClusters> counts{};
+
+    for (int iteration = 0; iteration < kMaxIterations; ++iteration) {
+        const size_t changed = assign(samples, centroids, labels);
+
+        std::array<float, kClusters> sum_r{}, sum_g{}, sum_b{};
+        counts.fill(0);
+        for (size_t i = 0; i < samples.count; ++i) {
+            const size_t c = static_cast<size_t>(labels[i]);
+            ++counts[c];
+            sum_r[c] += samples.r[i];
+            sum_g[c] += samples.g[i];
+            sum_b[c] += samples.b[i];
+        }
+
+        // Empty clusters keep their seed and are dropped below
+        for (size_t c = 0; c < centroids.count; ++c) {
+            if (counts[c] == 0) continue;
+            centroids.r[c] = sum_r[c] / counts[c];
+            centroids.g[c] = sum_g[c] / counts[c];
+            centroids.b[c] = sum_b[c] / counts[c];
+        }
+
+        if (changed == 0) break;
+    }
+
+    for (size_t c = 0; c < centroids.count; ++c) {
+        if (counts[c] == 0) continue;
+        Color color;
+        color.r = to_channel(centroids.r[c]);
+        color.g = to_channel(centroids.g[c]);
+        color.b = to_channel(centroids.b[c]);
+        color.weight = static_cast<float>(counts[c]) / static_cast<float>(samples.count);
+        result.colors.push_back(color);
+    }
+
+    std::sort(result.colors.begin(), result.colors.end(),
+              [](const Color& a, const Color& b) { return a.weight > b.weight; });
+
+    // Accent: the most saturated color covering a visible part of the artwork,
+    // otherwise the runner-up
+    result.dominant = 0;
+    result.accent = result.colors.size() > 1 ? 1 : 0;
+    int best_chroma = -1;
+    for (size_t i = 1; i < result.colors.size(); ++i) {
+        if (result.colors[i].weight < 0.05f) continue;
+        const int value = chroma(result.colors[i]);
+        if (value > best_chroma) {
+            best_chroma = value;
+            result.accent = i;
+        }
+    }
+    return result;
+}
+
+std::string to_hex(const Color& color) {
+    char buffer[8];
+    std::snprintf(buffer, sizeof(buffer), "#%02x%02x%02x", color.r, color.g, color.b);
+    return buffer;
+}
+
+} // namespace palette
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Artwork palette
+//
+// Dominant and accent colors of a decoded thumbnail, for theming LEDs and the
+// deck to the current track. Input is 8-bit BGRA pixels, already downscaled by
+// the decoder (kSampleEdge on the long side is plenty); every pixel of that is
+// clustered with k-means, whose distance pass runs four pixels at a time with
+// SSE2 or NEON and falls back to scalar code elsewhere. A 64x64 sample takes
+// well under a millisecond.
+//
+// Decoding is left to the platform: on Windows the thumbnail stream goes through
+// BitmapDecoder. Linux players only expose an art URL, so no palette there.
+
+namespace palette {
+
+// Decoder target for the longest thumbnail edge
+constexpr uint32_t kSampleEdge = 64;
+
+// Number of clusters (and at most this many colors reported)
+constexpr size_t kClusters = 5;
+
+struct Color {
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    float weight = 0;  // share of opaque sampled pixels in this cluster
+};
+
+struct Palette {
+    std::vector<Color> colors;  // heaviest first
+    size_t dominant = 0;        // index into colors
+    size_t accent = 0;          // most vivid color with a meaningful share
+};
+
+// Cluster BGRA pixels (stride in bytes). Pixels with alpha below 128 are
+// skipped; an empty palette means nothing opaque was found.
+Palette extract(const uint8_t* bgra, uint32_t width, uint32_t height, uint32_t stride);
+
+// "#rrggbb"
+std::string to_hex(const Color& color);
+
+// Palettes of recently played tracks, so skipping back and forth does not decode
+// the same artwork again
+class Cache {
+public:
+    explicit Cache(size_t capacity = 64) : capacity(capacity) {}
+
+    bool find(const std::string& key, Palette& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it == entries.end()) return false;
+        order.splice(order.begin(), order, it->second.second);
+        out = it->second.first;
+        return true;
+    }
+
+    void put(const std::string& key, Palette value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            it->second.first = std::move(value);
+            order.splice(order.begin(), order, it->second.second);
+            return;
+        }
+
+        order.push_front(key);
+        entries.emplace(key, std::make_pair(std::move(value), order.begin()));
+        if (entries.size() > capacity) {
+            entries.erase(order.back());
+            order.pop_back();
+        }
+    }
+
+private:
+    size_t capacity;
+    std::mutex mutex;
+    std::list<std::string> order;
+    std::unordered_map<std::string, std::pair<Palette, std::list<std::string>::iterator>> entries;
+};
+
+} // namespace palette
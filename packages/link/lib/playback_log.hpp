@@ -0,0 +1,427 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Playback history ring log
+//
+// Listening history is appended as fixed-size binary records to a memory-mapped
+// ring file. Only transitions are written (track change, play/pause, seek), so the
+// per-second polling path costs a hash compare when nothing changed. Titles and
+// artists go into a second byte ring in the same file, written once per track
+// change and shared by the status and seek records that follow, so each record
+// stays 48 bytes. The file size is fixed: both rings wrap, old records are
+// overwritten and readers are told how many they missed. A record whose strings
+// were overwritten first reads back with an empty title and artist.
+//
+// File layout: [Header][Record x kRecordCapacity][string bytes x kStringBytes]
+
+namespace playback_log {
+
+constexpr uint32_t kMagic = 0x474F4C59; // "YLOG"
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kRecordCapacity = 1 << 16;
+constexpr uint32_t kStringBytes = 1 << 20;
+constexpr uint32_t kMaxStringLength = 255;
+constexpr uint64_t kNoString = ~0ULL;
+constexpr uint32_t kMaxBatch = 4096;
+
+// Position jumps larger than this (while playing) are logged as seeks
+constexpr double kSeekThresholdSeconds = 3.0;
+
+enum class Event : uint8_t {
+    TrackChange = 1,
+    StatusChange = 2,
+    Seek = 3,
+};
+
+enum class Status : uint8_t {
+    Unknown = 0,
+    Playing = 1,
+    Paused = 2,
+    Stopped = 3,
+    Closed = 4,
+    Changing = 5,
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordCapacity;
+    uint32_t stringBytes;
+    uint64_t nextSeq;       // sequence number of the next record to be written
+    uint64_t stringHead;    // total bytes ever written to the string ring
+    uint64_t reserved[4];
+};
+static_assert(sizeof(Header) == 64, "playback log header must stay 64 bytes");
+
+struct Record {
+    uint64_t seq;
+    uint64_t monotonicNs;   // steady clock, for ordering and durations within a boot
+    uint64_t unixMs;        // wall clock, for placing records on a calendar
+    uint64_t trackHash;     // FNV-1a of "title\x1fartist"
+    uint64_t stringOffset;  // position of the track's strings in the string ring
+    uint32_t positionMs;
+    uint8_t status;
+    uint8_t event;
+    uint16_t reserved;
+};
+static_assert(sizeof(Record) == 48, "playback log record must stay 48 bytes");
+
+constexpr size_t kFileSize = sizeof(Header)
+    + sizeof(Record) * kRecordCapacity
+    + kStringBytes;
+
+inline uint64_t fnv1a(const char* data, size_t len, uint64_t seed = 0xcbf29ce484222325ULL) {
+    uint64_t hash = seed;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+inline uint64_t track_hash(const std::string& title, const std::string& artist) {
+    uint64_t hash = fnv1a(title.data(), title.size());
+    hash = fnv1a("\x1f", 1, hash);
+    return fnv1a(artist.data(), artist.size(), hash);
+}
+
+inline Status parse_status(const std::string& status) {
+    // Only the first two letters are needed to tell the backends' status strings
+    // apart; compare them case-insensitively.
+    if (status.empty()) return Status::Unknown;
+    switch (status[0] | 0x20) {
+        case 'p': return (status.size() > 1 && (status[1] | 0x20) == 'l') ? Status::Playing : Status::Paused;
+        case 's': return Status::Stopped;
+        case 'c': return (status.size() > 1 && (status[1] | 0x20) == 'l') ? Status::Closed : Status::Changing;
+        default: return Status::Unknown;
+    }
+}
+
+inline const char* status_name(uint8_t status) {
+    switch (static_cast<Status>(status)) {
+        case Status::Playing: return "Playing";
+        case Status::Paused: return "Paused";
+        case Status::Stopped: return "Stopped";
+        case Status::Closed: return "Closed";
+        case Status::Changing: return "Changing";
+        default: return "Unknown";
+    }
+}
+
+inline const char* event_name(uint8_t event) {
+    switch (static_cast<Event>(event)) {
+        case Event::TrackChange: return "track";
+        case Event::StatusChange: return "status";
+        case Event::Seek: return "seek";
+        default: return "unknown";
+    }
+}
+
+class PlaybackLog {
+public:
+    PlaybackLog() = default;
+    PlaybackLog(const PlaybackLog&) = delete;
+    PlaybackLog& operator=(const PlaybackLog&) = delete;
+    ~PlaybackLog() { close(); }
+
+    // Map (and create if needed) the ring file. An existing file with a different
+    // layout is reset rather than misread.
+    bool open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+
+#if defined(_WIN32) || defined(_WIN64)
+        file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                           nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                     static_cast<DWORD>(static_cast<uint64_t>(kFileSize) >> 32),
+                                     static_cast<DWORD>(kFileSize & 0xFFFFFFFF), nullptr);
+        if (!mapping) {
+            unmap();
+            return false;
+        }
+
+        base = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, kFileSize));
+        if (!base) {
+            unmap();
+            return false;
+        }
+#else
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) return false;
+
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) != kFileSize && ftruncate(fd, kFileSize) != 0)) {
+            unmap();
+            return false;
+        }
+
+        void* mapped = mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            unmap();
+            return false;
+        }
+        base = static_cast<uint8_t*>(mapped);
+#endif
+
+        header = reinterpret_cast<Header*>(base);
+        records = reinterpret_cast<Record*>(base + sizeof(Header));
+        strings = base + sizeof(Header) + sizeof(Record) * kRecordCapacity;
+
+        if (header->magic != kMagic || header->version != kVersion ||
+            header->recordCapacity != kRecordCapacity || header->stringBytes != kStringBytes) {
+            std::memset(base, 0, kFileSize);
+            header->magic = kMagic;
+            header->version = kVersion;
+            header->recordCapacity = kRecordCapacity;
+            header->stringBytes = kStringBytes;
+        }
+
+        last = Observed{};
+        opened.store(true, std::memory_order_release);
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        unmap();
+    }
+
+    bool is_open() const {
+        return opened.load(std::memory_order_acquire);
+    }
+
+    // Feed the latest polled state. Appends a record only when the track, status or
+    // position (beyond normal progress) changed since the previous observation.
+    void observe(const std::string& title, const std::string& artist,
+                 const std::string& statusText, double positionSeconds) {
+        observe(title, artist, statusText, positionSeconds, std::chrono::steady_clock::now());
+    }
+
+    void observe(const std::string& title, const std::string& artist,
+                 const std::string& statusText, double positionSeconds,
+                 std::chrono::steady_clock::time_point now) {
+        if (!opened.load(std::memory_order_acquire)) return;
+
+        const uint64_t hash = track_hash(title, artist);
+        const Status status = parse_status(statusText);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!header) return;
+
+        Event event;
+        if (!last.valid || hash != last.trackHash) {
+            event = Event::TrackChange;
+        } else if (status != last.status) {
+            event = Event::StatusChange;
+        } else if (status == Status::Playing) {
+            double elapsed = std::chrono::duration<double>(now - last.at).count();
+            double expected = last.position + elapsed;
+            if (std::abs(positionSeconds - expected) <= kSeekThresholdSeconds) {
+                last.position = positionSeconds;
+                last.at = now;
+                return;
+            }
+            event = Event::Seek;
+        } else {
+            return;
+        }
+
+        Record& record = records[header->nextSeq % kRecordCapacity];
+        record.seq = header->nextSeq;
+        record.monotonicNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count());
+        record.unixMs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        record.trackHash = hash;
+        record.stringOffset = event == Event::TrackChange ? append_strings(title, artist) : last.stringOffset;
+        record.positionMs = positionSeconds > 0 ? static_cast<uint32_t>(positionSeconds * 1000.0) : 0;
+        record.status = static_cast<uint8_t>(status);
+        record.event = static_cast<uint8_t>(event);
+        record.reserved = 0;
+
+        // Publish the record before advancing the cursor so readers of the mapped
+        // file never see a sequence number whose slot is still being written.
+        std::atomic_thread_fence(std::memory_order_release);
+        header->nextSeq++;
+
+        last.valid = true;
+        last.trackHash = hash;
+        last.stringOffset = record.stringOffset;
+        last.status = status;
+        last.position = positionSeconds;
+        last.at = now;
+    }
+
+    // Read up to maxRecords records starting at cursor. The returned "cursor" is the
+    // value to pass on the next call; "dropped" counts records overwritten before
+    // they could be read.
+    nlohmann::json read(uint64_t cursor, uint32_t maxRecords) {
+        nlohmann::json out;
+        out["records"] = nlohmann::json::array();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!header) {
+            out["error"] = "Playback log is not open";
+            return out;
+        }
+
+        const uint64_t next = header->nextSeq;
+        const uint64_t oldest = next > kRecordCapacity ? next - kRecordCapacity : 0;
+        const uint64_t start = cursor < oldest ? oldest : (cursor > next ? next : cursor);
+        const uint32_t batch = maxRecords == 0 || maxRecords > kMaxBatch ? kMaxBatch : maxRecords;
+        const uint64_t end = (next - start) > batch ? start + batch : next;
+
+        for (uint64_t seq = start; seq < end; ++seq) {
+            const Record& record = records[seq % kRecordCapacity];
+            std::string title, artist;
+            read_strings(record.stringOffset, title, artist);
+            out["records"].push_back({
+                {"seq", record.seq},
+                {"event", event_name(record.event)},
+                {"monotonic_ns", record.monotonicNs},
+                {"time", record.unixMs},
+                {"track", hex(record.trackHash)},
+                {"title", title},
+                {"artist", artist},
+                {"status", status_name(record.status)},
+                {"position_ms", record.positionMs},
+            });
+        }
+
+        out["cursor"] = end;
+        out["dropped"] = cursor < oldest ? oldest - cursor : 0;
+        return out;
+    }
+
+private:
+    struct Observed {
+        bool valid = false;
+        uint64_t trackHash = 0;
+        uint64_t stringOffset = kNoString;
+        Status status = Status::Unknown;
+        double position = 0;
+        std::chrono::steady_clock::time_point at;
+    };
+
+    // Entry layout: [title length][artist length][title][artist], each string
+    // truncated to kMaxStringLength bytes on a UTF-8 boundary. Entries may wrap
+    // around the end of the ring.
+    uint64_t append_strings(const std::string& title, const std::string& artist) {
+        const size_t titleLength = clamp_length(title);
+        const size_t artistLength = clamp_length(artist);
+
+        const uint64_t offset = header->stringHead;
+        const uint8_t lengths[2] = {static_cast<uint8_t>(titleLength), static_cast<uint8_t>(artistLength)};
+        ring_copy_in(offset, lengths, sizeof(lengths));
+        ring_copy_in(offset + 2, title.data(), titleLength);
+        ring_copy_in(offset + 2 + titleLength, artist.data(), artistLength);
+
+        header->stringHead = offset + 2 + titleLength + artistLength;
+        return offset;
+    }
+
+    // Leaves both strings empty when the entry has already been overwritten
+    void read_strings(uint64_t offset, std::string& title, std::string& artist) const {
+        const uint64_t head = header->stringHead;
+        const uint64_t oldest = head > kStringBytes ? head - kStringBytes : 0;
+        if (offset == kNoString || offset < oldest || offset + 2 > head) return;
+
+        uint8_t lengths[2];
+        ring_copy_out(offset, lengths, sizeof(lengths));
+        if (offset + 2 + lengths[0] + lengths[1] > head) return;
+
+        title.resize(lengths[0]);
+        artist.resize(lengths[1]);
+        ring_copy_out(offset + 2, title.data(), lengths[0]);
+        ring_copy_out(offset + 2 + lengths[0], artist.data(), lengths[1]);
+    }
+
+    static size_t clamp_length(const std::string& value) {
+        size_t length = value.size();
+        if (length > kMaxStringLength) {
+            length = kMaxStringLength;
+            while (length > 0 && (static_cast<uint8_t>(value[length]) & 0xC0) == 0x80) --length;
+        }
+        return length;
+    }
+
+    void ring_copy_in(uint64_t offset, const void* data, size_t length) {
+        const size_t at = static_cast<size_t>(offset % kStringBytes);
+        const size_t first = length < kStringBytes - at ? length : kStringBytes - at;
+        std::memcpy(strings + at, data, first);
+        std::memcpy(strings, static_cast<const uint8_t*>(data) + first, length - first);
+    }
+
+    void ring_copy_out(uint64_t offset, void* data, size_t length) const {
+        const size_t at = static_cast<size_t>(offset % kStringBytes);
+        const size_t first = length < kStringBytes - at ? length : kStringBytes - at;
+        std::memcpy(data, strings + at, first);
+        std::memcpy(static_cast<uint8_t*>(data) + first, strings, length - first);
+    }
+
+    // 64-bit hashes do not survive a JS number, so they are exported as hex
+    static std::string hex(uint64_t value) {
+        char buffer[17];
+        snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+        return std::string(buffer);
+    }
+
+    void unmap() {
+        opened.store(false, std::memory_order_release);
+        header = nullptr;
+        records = nullptr;
+        strings = nullptr;
+
+#if defined(_WIN32) || defined(_WIN64)
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(base, kFileSize);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        base = nullptr;
+    }
+
+    std::mutex mutex;
+    std::atomic<bool> opened{false};
+    uint8_t* base = nullptr;
+    Header* header = nullptr;
+    Record* records = nullptr;
+    uint8_t* strings = nullptr;
+    Observed last;
+
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+} // namespace playback_log
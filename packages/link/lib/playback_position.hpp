@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <utility>
+
+// Playback position estimate
+//
+// Some players only report a new timeline position on state changes and seeks,
+// so between reports the position is advanced by the time that actually passed
+// since the previous poll. Polls are not evenly spaced (session hints back them
+// off to several seconds), so nothing here assumes an interval.
+
+namespace playback_position {
+
+class Tracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Feed the position and duration the player reports (seconds) and whether it
+    // is playing; returns the estimated {position, duration}.
+    std::pair<double, double> update(double reported, double duration, bool playing, Clock::time_point now) {
+        if (duration > 0) total_duration = duration;
+
+        if (!initialized || reported != last_reported) {
+            // Fresh report: first poll, track change, seek or a player that keeps
+            // its timeline current
+            position = reported;
+            last_reported = reported;
+            initialized = true;
+        } else if (was_playing) {
+            position += std::chrono::duration<double>(now - updated_at).count();
+        }
+
+        updated_at = now;
+        was_playing = playing;
+
+        if (total_duration > 0 && position > total_duration) position = total_duration;
+        return {position, total_duration};
+    }
+
+    double duration() const { return total_duration; }
+
+private:
+    bool initialized = false;
+    bool was_playing = false;
+    double last_reported = 0;
+    double position = 0;
+    double total_duration = 0;
+    Clock::time_point updated_at;
+};
+
+} // namespace playback_position
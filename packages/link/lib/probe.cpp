@@ -0,0 +1,79 @@
+#include "probe.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace probe {
+
+bool has_executable(const char* name) {
+#if defined(_WIN32) || defined(_WIN64)
+    char found[MAX_PATH];
+    return SearchPathA(nullptr, name, ".exe", MAX_PATH, found, nullptr) > 0;
+#else
+    const char* path_env = std::getenv("PATH");
+    std::string paths = path_env ? path_env : "/usr/local/bin:/usr/bin:/bin";
+
+    size_t start = 0;
+    while (start <= paths.size()) {
+        size_t end = paths.find(':', start);
+        if (end == std::string::npos) end = paths.size();
+
+        std::string dir = paths.substr(start, end - start);
+        if (dir.empty()) dir = ".";
+
+        std::string candidate = dir + "/" + name;
+        struct stat st {};
+        if (stat(candidate.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            return true;
+        }
+
+        start = end + 1;
+    }
+    return false;
+#endif
+}
+
+bool dir_has_entries(const char* path) {
+#if defined(_WIN32) || defined(_WIN64)
+    std::string pattern = std::string(path) + "\\*";
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(pattern.c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) return false;
+
+    bool found = false;
+    do {
+        if (strcmp(data.cFileName, ".") != 0 && strcmp(data.cFileName, "..") != 0) {
+            found = true;
+            break;
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+    return found;
+#else
+    DIR* dir = opendir(path);
+    if (!dir) return false;
+
+    bool found = false;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.' && (entry->d_name[1] == '\0' ||
+            (entry->d_name[1] == '.' && entry->d_name[2] == '\0'))) {
+            continue;
+        }
+        found = true;
+        break;
+    }
+    closedir(dir);
+    return found;
+#endif
+}
+
+} // namespace probe
@@ -0,0 +1,17 @@
+#pragma once
+
+// Backend probes
+//
+// Cheap checks used to decide which backends are usable without spawning a
+// process (no `which`, no shell). Callers cache the answers; nothing here runs
+// at library load time.
+
+namespace probe {
+
+// Look up an executable by name, the way the shell would resolve it
+bool has_executable(const char* name);
+
+// True when the directory exists and has at least one entry besides . and ..
+bool dir_has_entries(const char* path);
+
+} // namespace probe
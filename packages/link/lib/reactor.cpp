@@ -0,0 +1,675 @@
+#include "reactor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    #include <objbase.h>
+#else
+    #include <cerrno>
+    #include <csignal>
+    #include <fcntl.h>
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <sys/prctl.h>
+    #include <sys/syscall.h>
+    #include <sys/timerfd.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace reactor {
+namespace {
+
+void run_guarded(const Task& task, const char* what) {
+    TRACE_SCOPE(what, "reactor");
+    try {
+        task();
+    } catch (const std::exception& ex) {
+        std::cerr << "Error in reactor " << what << ": " << ex.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown error in reactor " << what << std::endl;
+    }
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+class Reactor {
+public:
+    Reactor() {
+        wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        std::thread([this] { loop(); }).detach();
+    }
+
+    void post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(task));
+        }
+        SetEvent(wake);
+    }
+
+    bool on_thread() const {
+        return std::this_thread::get_id() == thread_id.load();
+    }
+
+    int add_timer(uint32_t interval_ms, Task fn, bool repeat) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int id = ++next_timer_id;
+        timers[id] = Timer{std::chrono::milliseconds(interval_ms),
+                           Clock::now() + std::chrono::milliseconds(interval_ms), std::move(fn), repeat};
+        SetEvent(wake);
+        return id;
+    }
+
+    void cancel_timer(int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        timers.erase(id);
+    }
+
+    std::string stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return "{\"queued\":" + std::to_string(queue.size()) +
+               ",\"timers\":" + std::to_string(timers.size()) + "}";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        std::chrono::milliseconds interval;
+        Clock::time_point due;
+        Task fn;
+        bool repeat;
+    };
+
+    void loop() {
+        thread_id.store(std::this_thread::get_id());
+        trace::name_thread("reactor");
+
+        // Everything created on this thread lives in the MTA, so the handles can
+        // be shared with whichever thread bun calls an export on
+        CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+        while (true) {
+            WaitForSingleObject(wake, next_timeout());
+
+            std::vector<Task> tasks;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.swap(queue);
+            }
+            for (const auto& task : tasks) run_guarded(task, "task");
+
+            for (const auto& task : due_timers()) run_guarded(task, "timer");
+        }
+    }
+
+    DWORD next_timeout() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!queue.empty()) return 0;
+        if (timers.empty()) return INFINITE;
+
+        auto next = Clock::time_point::max();
+        for (const auto& [id, timer] : timers) next = std::min(next, timer.due);
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+        return wait <= 0 ? 0 : static_cast<DWORD>(wait);
+    }
+
+    std::vector<Task> due_timers() {
+        std::vector<Task> due;
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = Clock::now();
+        for (auto it = timers.begin(); it != timers.end();) {
+            Timer& timer = it->second;
+            if (timer.due > now) {
+                ++it;
+                continue;
+            }
+
+            due.push_back(timer.fn);
+            if (timer.repeat) {
+                timer.due = now + timer.interval;
+                ++it;
+            } else {
+                it = timers.erase(it);
+            }
+        }
+        return due;
+    }
+
+    HANDLE wake = nullptr;
+    std::atomic<std::thread::id> thread_id{};
+    std::mutex mutex;
+    std::vector<Task> queue;
+    std::map<int, Timer> timers;
+    int next_timer_id = 0;
+};
+
+#else
+
+struct Captured {
+    std::function<void(int, const std::string&)> on_done;
+    std::string output;
+    int fd = -1;
+    int timer = -1;
+    bool exited = false;
+    int code = -1;
+};
+
+// How long a follower that closed stdout gets to exit after SIGTERM before it
+// is killed
+constexpr uint32_t kStopTimeoutMs = 2000;
+
+struct Followed {
+    std::vector<std::string> argv;
+    std::function<void(const std::string&)> on_line;
+    Task on_start;
+    Task on_exit;
+    uint32_t restart_ms = 5000;
+    pid_t pid = -1;
+    int fd = -1;
+    std::string buffer;
+};
+
+class Reactor {
+public:
+    Reactor() {
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        register_fd(wake_fd, EPOLLIN, [this](uint32_t) {
+            uint64_t count;
+            while (read(wake_fd, &count, sizeof(count)) > 0) {}
+            drain_queue();
+        });
+
+        if (inotify_fd >= 0) {
+            register_fd(inotify_fd, EPOLLIN, [this](uint32_t) { drain_inotify(); });
+        }
+
+        std::thread([this] { loop(); }).detach();
+    }
+
+    // Reactor thread only
+    std::string stats() {
+        size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued = queue.size();
+        }
+        size_t watch_count = 0;
+        for (const auto& [wd, list] : watches) watch_count += list.size();
+
+        return "{\"queued\":" + std::to_string(queued) +
+               ",\"timers\":" + std::to_string(timers.size()) +
+               ",\"fds\":" + std::to_string(handlers.size()) +
+               ",\"watches\":" + std::to_string(watch_count) +
+               ",\"followers\":" + std::to_string(followers) + "}";
+    }
+
+    void post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(std::move(task));
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+
+    bool on_thread() const {
+        return std::this_thread::get_id() == thread_id.load();
+    }
+
+    // Handler maps are only touched on the reactor thread; the public entry
+    // points below hop onto it first
+    bool register_fd(int fd, uint32_t events, std::function<void(uint32_t)> handler) {
+        epoll_event event {};
+        event.events = events;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) return false;
+        handlers[fd] = std::move(handler);
+        return true;
+    }
+
+    void unregister_fd(int fd) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        handlers.erase(fd);
+    }
+
+    int start_timer(uint32_t interval_ms, Task fn, bool repeat) {
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) return -1;
+
+        itimerspec spec {};
+        spec.it_value.tv_sec = interval_ms / 1000;
+        spec.it_value.tv_nsec = static_cast<long>(interval_ms % 1000) * 1000000L;
+        if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1;
+        if (repeat) spec.it_interval = spec.it_value;
+        timerfd_settime(fd, 0, &spec, nullptr);
+
+        int id = ++next_timer_id;
+        timers[id] = fd;
+
+        register_fd(fd, EPOLLIN, [this, id, fd, repeat, fn = std::move(fn)](uint32_t) {
+            uint64_t expirations;
+            ssize_t got = read(fd, &expirations, sizeof(expirations));
+            (void)got;
+            if (!repeat) stop_timer(id);
+            run_guarded(fn, "timer");
+        });
+        return id;
+    }
+
+    void stop_timer(int id) {
+        auto it = timers.find(id);
+        if (it == timers.end()) return;
+        unregister_fd(it->second);
+        close(it->second);
+        timers.erase(it);
+    }
+
+    bool watch(const std::string& path, uint32_t mask, std::function<void(uint32_t)> handler) {
+        if (inotify_fd < 0) return false;
+        int wd = inotify_add_watch(inotify_fd, path.c_str(), mask);
+        if (wd < 0) return false;
+        watches[wd].push_back(std::move(handler));
+        return true;
+    }
+
+    void follow(std::shared_ptr<Followed> process) {
+        int pipe_fds[2];
+        if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+            restart_later(process);
+            return;
+        }
+
+        // The child dies with the link
+        pid_t pid = fork_child(process->argv, pipe_fds[1], true);
+        close(pipe_fds[1]);
+        if (pid < 0) {
+            close(pipe_fds[0]);
+            restart_later(process);
+            return;
+        }
+
+        fcntl(pipe_fds[0], F_SETFL, fcntl(pipe_fds[0], F_GETFL) | O_NONBLOCK);
+        ++followers;
+        process->pid = pid;
+        process->fd = pipe_fds[0];
+        process->buffer.clear();
+        if (process->on_start) run_guarded(process->on_start, "process start");
+
+        register_fd(process->fd, EPOLLIN | EPOLLHUP | EPOLLERR, [this, process](uint32_t) {
+            char chunk[4096];
+            ssize_t got;
+            while ((got = read(process->fd, chunk, sizeof(chunk))) > 0) {
+                process->buffer.append(chunk, static_cast<size_t>(got));
+
+                size_t newline;
+                while ((newline = process->buffer.find('\n')) != std::string::npos) {
+                    std::string line = process->buffer.substr(0, newline);
+                    process->buffer.erase(0, newline + 1);
+                    run_guarded([&] { process->on_line(line); }, "process line");
+                }
+            }
+
+            // EOF (or a hard error) means the process is gone or closed stdout
+            if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+                reap(process);
+            }
+        });
+    }
+
+    void start(std::vector<std::string> argv, std::function<void(int)> on_exit) {
+        pid_t pid = fork_child(argv, -1, false);
+        if (pid < 0) {
+            if (on_exit) run_guarded([&] { on_exit(-1); }, "spawn exit");
+            return;
+        }
+        watch_exit(pid, std::move(on_exit));
+    }
+
+    void capture(std::vector<std::string> argv, std::function<void(int, const std::string&)> on_done,
+                 uint32_t timeout_ms) {
+        int pipe_fds[2];
+        if (pipe2(pipe_fds, O_CLOEXEC) != 0) {
+            run_guarded([&] { on_done(-1, ""); }, "capture exit");
+            return;
+        }
+
+        pid_t pid = fork_child(argv, pipe_fds[1], false);
+        close(pipe_fds[1]);
+        if (pid < 0) {
+            close(pipe_fds[0]);
+            run_guarded([&] { on_done(-1, ""); }, "capture exit");
+            return;
+        }
+
+        // Output is complete once stdout hits EOF and the exit status is known,
+        // in either order
+        auto state = std::make_shared<Captured>();
+        state->fd = pipe_fds[0];
+        state->on_done = std::move(on_done);
+        fcntl(state->fd, F_SETFL, fcntl(state->fd, F_GETFL) | O_NONBLOCK);
+
+        register_fd(state->fd, EPOLLIN | EPOLLHUP | EPOLLERR, [this, state](uint32_t) {
+            char chunk[4096];
+            ssize_t got;
+            while ((got = read(state->fd, chunk, sizeof(chunk))) > 0) {
+                state->output.append(chunk, static_cast<size_t>(got));
+            }
+            if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+                unregister_fd(state->fd);
+                close(state->fd);
+                state->fd = -1;
+                finish_capture(state);
+            }
+        });
+
+        // A hung child is killed; its exit then completes the capture
+        state->timer = start_timer(timeout_ms, [pid, state] {
+            state->timer = -1;
+            if (!state->exited) kill(pid, SIGKILL);
+        }, false);
+
+        watch_exit(pid, [this, state](int code) {
+            state->exited = true;
+            state->code = code;
+            finish_capture(state);
+        });
+    }
+
+private:
+    void loop() {
+        thread_id.store(std::this_thread::get_id());
+        trace::name_thread("reactor");
+
+        epoll_event events[32];
+        while (true) {
+            int count = epoll_wait(epoll_fd, events, 32, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                std::cerr << "Reactor epoll_wait failed: " << errno << std::endl;
+                return;
+            }
+
+            for (int i = 0; i < count; ++i) {
+                auto it = handlers.find(events[i].data.fd);
+                if (it == handlers.end()) continue;
+
+                // Copy: the handler may unregister itself
+                auto handler = it->second;
+                uint32_t mask = events[i].events;
+                run_guarded([&] { handler(mask); }, "fd handler");
+            }
+        }
+    }
+
+    void drain_queue() {
+        std::vector<Task> tasks;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.swap(queue);
+        }
+        for (const auto& task : tasks) run_guarded(task, "task");
+    }
+
+    void drain_inotify() {
+        alignas(inotify_event) char buffer[4096];
+        ssize_t got;
+        while ((got = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char* ptr = buffer; ptr < buffer + got;) {
+                auto* event = reinterpret_cast<inotify_event*>(ptr);
+                auto it = watches.find(event->wd);
+                if (it != watches.end()) {
+                    for (const auto& handler : it->second) {
+                        uint32_t mask = event->mask;
+                        run_guarded([&] { handler(mask); }, "watch handler");
+                    }
+                }
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    // Fork and exec argv without a shell. stdout goes to stdout_fd (or
+    // /dev/null when negative), stdin and stderr to /dev/null.
+    pid_t fork_child(std::vector<std::string>& argv, int stdout_fd, bool die_with_parent) {
+        std::vector<char*> args;
+        for (auto& arg : argv) args.push_back(arg.data());
+        args.push_back(nullptr);
+
+        pid_t pid;
+        {
+            TRACE_SCOPE("fork", "spawn");
+            pid = fork();
+        }
+        if (pid == 0) {
+            if (die_with_parent) prctl(PR_SET_PDEATHSIG, SIGTERM);
+            int null_fd = open("/dev/null", O_RDWR);
+            dup2(null_fd, STDIN_FILENO);
+            dup2(stdout_fd >= 0 ? stdout_fd : null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            execvp(args[0], args.data());
+            _exit(127);
+        }
+        return pid;
+    }
+
+    // Report the exit code of pid exactly once. If the child was reaped
+    // elsewhere (SIGCHLD ignored, another waitpid caller) the code is -1.
+    void watch_exit(pid_t pid, std::function<void(int)> on_exit) {
+        auto finish = [pid, on_exit = std::move(on_exit)](bool block) {
+            int status = 0;
+            pid_t reaped;
+            do {
+                reaped = waitpid(pid, &status, block ? 0 : WNOHANG);
+            } while (reaped < 0 && errno == EINTR);
+            if (reaped == 0) return false;
+
+            int code = reaped == pid && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            if (on_exit) run_guarded([&] { on_exit(code); }, "spawn exit");
+            return true;
+        };
+
+        // A pidfd becomes readable when the child exits; kernels without
+        // pidfd_open (< 5.3) fall back to checking on a short timer
+        int pid_fd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+        if (pid_fd >= 0 && register_fd(pid_fd, EPOLLIN, [this, pid_fd, finish](uint32_t) {
+                unregister_fd(pid_fd);
+                close(pid_fd);
+                finish(true);
+            })) {
+            return;
+        }
+        if (pid_fd >= 0) close(pid_fd);
+
+        auto timer = std::make_shared<int>(-1);
+        *timer = start_timer(20, [this, timer, finish] {
+            if (finish(false)) stop_timer(*timer);
+        }, true);
+    }
+
+    void finish_capture(const std::shared_ptr<Captured>& state) {
+        if (state->fd >= 0 || !state->exited || !state->on_done) return;
+        if (state->timer >= 0) stop_timer(state->timer);
+        state->timer = -1;
+
+        auto on_done = std::move(state->on_done);
+        state->on_done = nullptr;
+        run_guarded([&] { on_done(state->code, state->output); }, "capture exit");
+    }
+
+    // stdout is closed but the process may still be running: ask it to stop,
+    // kill it if it is still there after kStopTimeoutMs, and restart it once
+    // watch_exit has seen it go. The loop never waits on it.
+    void reap(const std::shared_ptr<Followed>& process) {
+        --followers;
+        unregister_fd(process->fd);
+        close(process->fd);
+        process->fd = -1;
+
+        pid_t pid = process->pid;
+        process->pid = -1;
+        if (pid <= 0) {
+            if (process->on_exit) run_guarded(process->on_exit, "process exit");
+            restart_later(process);
+            return;
+        }
+
+        // Until it is reaped the pid cannot be reused, so the signals below only
+        // ever reach this child
+        kill(pid, SIGTERM);
+        int kill_timer = start_timer(kStopTimeoutMs, [pid] { kill(pid, SIGKILL); }, false);
+
+        watch_exit(pid, [this, process, kill_timer](int) {
+            stop_timer(kill_timer);
+            if (process->on_exit) run_guarded(process->on_exit, "process exit");
+            restart_later(process);
+        });
+    }
+
+    void restart_later(const std::shared_ptr<Followed>& process) {
+        start_timer(process->restart_ms, [this, process] { follow(process); }, false);
+    }
+
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    int inotify_fd = -1;
+    std::atomic<std::thread::id> thread_id{};
+    std::mutex mutex;
+    std::vector<Task> queue;
+    std::unordered_map<int, std::function<void(uint32_t)>> handlers;
+    std::unordered_map<int, std::vector<std::function<void(uint32_t)>>> watches;
+    std::unordered_map<int, int> timers;
+    int next_timer_id = 0;
+    size_t followers = 0;
+};
+
+#endif
+
+// Started on first use and intentionally leaked, see reactor.hpp
+Reactor& instance() {
+    static Reactor* reactor = new Reactor();
+    return *reactor;
+}
+
+} // namespace
+
+void post(Task task) {
+    instance().post(std::move(task));
+}
+
+bool on_reactor_thread() {
+    return instance().on_thread();
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+int add_timer(uint32_t interval_ms, Task fn) {
+    return instance().add_timer(interval_ms, std::move(fn), true);
+}
+
+void cancel_timer(int id) {
+    instance().cancel_timer(id);
+}
+
+void schedule(uint32_t delay_ms, Task fn) {
+    instance().add_timer(delay_ms, std::move(fn), false);
+}
+
+#else
+
+int add_timer(uint32_t interval_ms, Task fn) {
+    return call([interval_ms, fn = std::move(fn)]() mutable {
+        return instance().start_timer(interval_ms, std::move(fn), true);
+    });
+}
+
+void cancel_timer(int id) {
+    post([id] { instance().stop_timer(id); });
+}
+
+void schedule(uint32_t delay_ms, Task fn) {
+    post([delay_ms, fn = std::move(fn)]() mutable {
+        instance().start_timer(delay_ms, std::move(fn), false);
+    });
+}
+
+bool add_fd(int fd, uint32_t events, std::function<void(uint32_t)> handler) {
+    return call([fd, events, handler = std::move(handler)]() mutable {
+        return instance().register_fd(fd, events, std::move(handler));
+    });
+}
+
+void remove_fd(int fd) {
+    call([fd] { instance().unregister_fd(fd); });
+}
+
+bool add_watch(const std::string& path, uint32_t mask, std::function<void(uint32_t)> handler) {
+    return call([path, mask, handler = std::move(handler)]() mutable {
+        return instance().watch(path, mask, std::move(handler));
+    });
+}
+
+void spawn(std::vector<std::string> argv, std::function<void(int)> on_exit) {
+    post([argv = std::move(argv), on_exit = std::move(on_exit)]() mutable {
+        instance().start(std::move(argv), std::move(on_exit));
+    });
+}
+
+void capture(std::vector<std::string> argv, std::function<void(int, const std::string&)> on_done,
+             uint32_t timeout_ms) {
+    post([argv = std::move(argv), on_done = std::move(on_done), timeout_ms]() mutable {
+        instance().capture(std::move(argv), std::move(on_done), timeout_ms);
+    });
+}
+
+void follow_process(std::vector<std::string> argv,
+                    std::function<void(const std::string&)> on_line,
+                    Task on_exit,
+                    uint32_t restart_ms,
+                    Task on_start) {
+    auto process = std::make_shared<Followed>();
+    process->argv = std::move(argv);
+    process->on_line = std::move(on_line);
+    process->on_start = std::move(on_start);
+    process->on_exit = std::move(on_exit);
+    process->restart_ms = restart_ms;
+
+    post([process] { instance().follow(process); });
+}
+
+#endif
+
+} // namespace reactor
+
+// Counts of what the reactor is currently servicing, for diagnostics
+extern "C" LINK_RUNTIME_API const char* getReactorStats() {
+    static std::string result_json;
+    static std::mutex result_mutex;
+
+    std::string stats;
+#if defined(_WIN32) || defined(_WIN64)
+    stats = reactor::instance().stats();
+#else
+    stats = reactor::call([] { return reactor::instance().stats(); });
+#endif
+
+    std::lock_guard<std::mutex> lock(result_mutex);
+    result_json = stats;
+    return result_json.c_str();
+}
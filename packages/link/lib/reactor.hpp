@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "runtime_api.hpp"
+#include "trace.hpp"
+
+// Reactor
+//
+// One event-loop thread shared by media_control and device_control (both link
+// against link_runtime). It owns the long-lived backend handles and keeps their
+// state current, so exports become cheap reads of cached state instead of
+// per-call process spawns or COM/WinRT setup.
+//
+// On Linux the loop multiplexes everything with epoll: an eventfd for posted
+// tasks, timerfds, inotify watches, sysfs attributes and the stdout of followed
+// processes (`playerctl --follow`, `pactl subscribe`). On Windows the thread joins
+// the MTA once and runs posted tasks and timers; COM and WinRT handles created on
+// it are reused by every call.
+//
+// The thread starts on first use and is never joined: it is torn down with the
+// process, which avoids waiting on it under the loader lock or in static
+// destructors.
+
+namespace reactor {
+
+using Task = std::function<void()>;
+
+// Queue a task to run on the reactor thread
+LINK_RUNTIME_API void post(Task task);
+
+// Whether the caller is the reactor thread
+LINK_RUNTIME_API bool on_reactor_thread();
+
+// Run fn on the reactor thread and wait for its result. Runs inline when already
+// on the reactor thread. Exceptions are rethrown in the caller.
+template <typename Fn>
+auto call(Fn&& fn) -> std::invoke_result_t<Fn&> {
+    using Result = std::invoke_result_t<Fn&>;
+    if (on_reactor_thread()) {
+        return fn();
+    }
+
+    auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+    std::future<Result> result = task->get_future();
+    post([task] { (*task)(); });
+    return result.get();
+}
+
+// Run fn on the reactor thread every interval_ms, first after one interval.
+// Returns an id for cancel_timer.
+LINK_RUNTIME_API int add_timer(uint32_t interval_ms, Task fn);
+LINK_RUNTIME_API void cancel_timer(int id);
+
+// Run fn once on the reactor thread after delay_ms
+LINK_RUNTIME_API void schedule(uint32_t delay_ms, Task fn);
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Watch a file descriptor; handler runs on the reactor thread with the epoll
+// events. The reactor does not take ownership of fd.
+LINK_RUNTIME_API bool add_fd(int fd, uint32_t events, std::function<void(uint32_t)> handler);
+LINK_RUNTIME_API void remove_fd(int fd);
+
+// Watch a path with inotify; handler runs on the reactor thread with the mask
+LINK_RUNTIME_API bool add_watch(const std::string& path, uint32_t mask, std::function<void(uint32_t)> handler);
+
+// Start a process without a shell and report its exit code on the reactor
+// thread (-1 if it could not be started). The reactor never blocks on it.
+LINK_RUNTIME_API void spawn(std::vector<std::string> argv, std::function<void(int)> on_exit = nullptr);
+
+// Start a process without a shell and report its exit code and stdout on the
+// reactor thread once it exits. The child is killed after timeout_ms.
+LINK_RUNTIME_API void capture(std::vector<std::string> argv,
+                              std::function<void(int, const std::string&)> on_done,
+                              uint32_t timeout_ms = 5000);
+
+// Longest run() waits for a process before giving up on it
+constexpr uint32_t kRunTimeoutMs = 10000;
+
+// Start a process through the reactor and wait for its exit code, or -1 if it
+// has not exited within timeout_ms. Not for use on the reactor thread.
+inline int run(std::vector<std::string> argv, uint32_t timeout_ms = kRunTimeoutMs) {
+    TRACE_SCOPE("run", "spawn");
+    auto done = std::make_shared<std::promise<int>>();
+    std::future<int> exit_code = done->get_future();
+    spawn(std::move(argv), [done](int code) { done->set_value(code); });
+    if (exit_code.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) return -1;
+    return exit_code.get();
+}
+
+// Keep a process running and deliver each line of its stdout on the reactor
+// thread. The process is restarted (after restart_ms) whenever it exits;
+// on_start and on_exit, if set, run each time it is started and each time it
+// exits. The child is killed with the parent.
+LINK_RUNTIME_API void follow_process(std::vector<std::string> argv,
+                                     std::function<void(const std::string&)> on_line,
+                                     Task on_exit = nullptr,
+                                     uint32_t restart_ms = 5000,
+                                     Task on_start = nullptr);
+#endif
+
+} // namespace reactor
@@ -0,0 +1,12 @@
+#pragma once
+
+// Portable export macro for the shared runtime library (link_runtime)
+#if defined(_WIN32) || defined(_WIN64)
+    #ifdef LINK_RUNTIME_EXPORTS
+        #define LINK_RUNTIME_API __declspec(dllexport)
+    #else
+        #define LINK_RUNTIME_API __declspec(dllimport)
+    #endif
+#else
+    #define LINK_RUNTIME_API __attribute__((visibility("default")))
+#endif
@@ -0,0 +1,262 @@
+#include "scene.hpp"
+#include "trace.hpp"
+
+#include <array>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace scene {
+namespace {
+
+// Operations on the same resource must stay ordered; different resources can be
+// driven at the same time
+enum class Lane {
+    Audio,
+    Display,
+    Media,
+    Power,
+    Invalid,
+};
+
+constexpr size_t kParallelLanes = 3; // Audio, Display, Media
+
+struct Operation {
+    std::string fn;
+    json args;
+    Lane lane;
+};
+
+struct Outcome {
+    bool ok = false;
+    std::string error;
+};
+
+Lane lane_for(const std::string& fn) {
+    if (fn == "volume" || fn == "mute") return Lane::Audio;
+    if (fn == "brightness") return Lane::Display;
+    if (fn == "playMedia" || fn == "pauseMedia" || fn == "nextTrack" ||
+        fn == "previousTrack" || fn == "seekTo") return Lane::Media;
+    if (fn == "lock" || fn == "sleep" || fn == "shutdown" || fn == "restart") return Lane::Power;
+    return Lane::Invalid;
+}
+
+// media_control exports, resolved from the library that sits next to
+// device_control. Loading an already loaded library returns the same handle, so
+// this shares media_control's state with the link's own bindings.
+struct MediaBackend {
+    bool (*play)() = nullptr;
+    bool (*pause)() = nullptr;
+    bool (*next)() = nullptr;
+    bool (*previous)() = nullptr;
+    bool (*seek)(const char*) = nullptr;
+    bool loaded = false;
+};
+
+const MediaBackend& media_backend() {
+    static MediaBackend backend;
+    static std::once_flag resolved;
+
+    std::call_once(resolved, [] {
+#if defined(_WIN32) || defined(_WIN64)
+        HMODULE self = nullptr;
+        if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                reinterpret_cast<LPCSTR>(&media_backend), &self)) {
+            return;
+        }
+
+        char path[MAX_PATH];
+        DWORD length = GetModuleFileNameA(self, path, MAX_PATH);
+        std::string dir(path, length);
+        dir = dir.substr(0, dir.find_last_of("\\/") + 1);
+
+        HMODULE library = LoadLibraryA((dir + "media_control.dll").c_str());
+        if (!library) return;
+
+        auto resolve = [library](const char* name) {
+            return reinterpret_cast<void*>(GetProcAddress(library, name));
+        };
+#else
+        Dl_info info {};
+        if (!dladdr(reinterpret_cast<void*>(&media_backend), &info) || !info.dli_fname) {
+            return;
+        }
+
+        std::string dir(info.dli_fname);
+        size_t slash = dir.find_last_of('/');
+        dir = slash == std::string::npos ? "" : dir.substr(0, slash + 1);
+
+    #if defined(__APPLE__)
+        void* library = dlopen((dir + "libmedia_control.dylib").c_str(), RTLD_NOW | RTLD_LOCAL);
+    #else
+        void* library = dlopen((dir + "libmedia_control.so").c_str(), RTLD_NOW | RTLD_LOCAL);
+    #endif
+        if (!library) return;
+
+        auto resolve = [library](const char* name) {
+            return dlsym(library, name);
+        };
+#endif
+        backend.play = reinterpret_cast<bool (*)()>(resolve("playMedia"));
+        backend.pause = reinterpret_cast<bool (*)()>(resolve("pauseMedia"));
+        backend.next = reinterpret_cast<bool (*)()>(resolve("nextTrack"));
+        backend.previous = reinterpret_cast<bool (*)()>(resolve("previousTrack"));
+        backend.seek = reinterpret_cast<bool (*)(const char*)>(resolve("seekTo"));
+        backend.loaded = backend.play && backend.pause && backend.next && backend.previous && backend.seek;
+    });
+
+    return backend;
+}
+
+Outcome fail(const std::string& error) {
+    return Outcome{false, error};
+}
+
+Outcome apply(const Operation& op, const DeviceBackend& device) {
+    try {
+        const json& args = op.args;
+
+        if (op.fn == "volume") {
+            if (!args.contains("level") || !args["level"].is_number()) return fail("volume requires level");
+            float level = args["level"].get<float>();
+            if (level < 0.0f || level > 1.0f) return fail("volume level must be between 0 and 1");
+            return device.setVolume(level) ? Outcome{true, ""} : fail("volume failed");
+        }
+        if (op.fn == "mute") {
+            return device.setMute(args.value("muted", args.value("enabled", true))) ? Outcome{true, ""} : fail("mute failed");
+        }
+        if (op.fn == "brightness") {
+            if (!args.contains("level") || !args["level"].is_number()) return fail("brightness requires level");
+            int level = args["level"].get<int>();
+            if (level < 0 || level > 100) return fail("brightness level must be between 0 and 100");
+            return device.setBrightness(level) ? Outcome{true, ""} : fail("brightness failed");
+        }
+
+        if (op.lane == Lane::Media) {
+            const MediaBackend& media = media_backend();
+            if (!media.loaded) return fail("media_control is not available");
+
+            bool ok = false;
+            if (op.fn == "playMedia") ok = media.play();
+            else if (op.fn == "pauseMedia") ok = media.pause();
+            else if (op.fn == "nextTrack") ok = media.next();
+            else if (op.fn == "previousTrack") ok = media.previous();
+            else if (op.fn == "seekTo") {
+                if (!args.contains("position") || !args["position"].is_number()) return fail("seekTo requires position");
+                double position = args["position"].get<double>();
+                if (position < 0) return fail("seekTo position must not be negative");
+                ok = media.seek(std::to_string(static_cast<long long>(position)).c_str());
+            }
+            return ok ? Outcome{true, ""} : fail(op.fn + " failed");
+        }
+
+        bool ok = false;
+        if (op.fn == "lock") ok = device.lock();
+        else if (op.fn == "sleep") ok = device.sleep();
+        else if (op.fn == "shutdown") ok = device.shutdown();
+        else if (op.fn == "restart") ok = device.restart();
+        else return fail("Unknown operation: " + op.fn);
+        return ok ? Outcome{true, ""} : fail(op.fn + " failed");
+    } catch (const std::exception& ex) {
+        return fail(ex.what());
+    }
+}
+
+} // namespace
+
+std::string run(const char* ops_json, const DeviceBackend& device) {
+    const auto started = std::chrono::steady_clock::now();
+    json result;
+
+    json input = json::parse(ops_json ? ops_json : "", nullptr, false);
+    if (input.is_discarded() || !input.is_array()) {
+        result["ok"] = false;
+        result["error"] = "Scene must be a JSON array of operations";
+        result["results"] = json::array();
+        return result.dump();
+    }
+
+    std::vector<Operation> ops;
+    ops.reserve(input.size());
+    for (const auto& item : input) {
+        Operation op;
+        if (item.is_object() && item.contains("fn") && item["fn"].is_string()) {
+            op.fn = item["fn"].get<std::string>();
+            op.args = item.contains("args") && item["args"].is_object() ? item["args"] : json::object();
+        }
+        op.lane = lane_for(op.fn);
+        ops.push_back(std::move(op));
+    }
+
+    std::vector<Outcome> outcomes(ops.size());
+    std::array<std::vector<size_t>, kParallelLanes> lanes;
+    std::vector<size_t> power;
+
+    for (size_t i = 0; i < ops.size(); ++i) {
+        switch (ops[i].lane) {
+            case Lane::Audio: lanes[0].push_back(i); break;
+            case Lane::Display: lanes[1].push_back(i); break;
+            case Lane::Media: lanes[2].push_back(i); break;
+            case Lane::Power: power.push_back(i); break;
+            case Lane::Invalid:
+                outcomes[i] = fail(ops[i].fn.empty() ? "Operation requires fn" : "Unknown operation: " + ops[i].fn);
+                break;
+        }
+    }
+
+    auto run_lane = [&](const std::vector<size_t>& indices) {
+        TRACE_SCOPE("lane", "scene");
+        for (size_t i : indices) {
+            outcomes[i] = apply(ops[i], device);
+        }
+    };
+
+    // Every busy lane but the first gets a helper thread; the first runs here
+    std::vector<std::future<void>> pending;
+    const std::vector<size_t>* inline_lane = nullptr;
+    for (const auto& lane : lanes) {
+        if (lane.empty()) continue;
+        if (!inline_lane) {
+            inline_lane = &lane;
+            continue;
+        }
+        pending.push_back(std::async(std::launch::async, run_lane, std::cref(lane)));
+    }
+
+    if (inline_lane) run_lane(*inline_lane);
+    for (auto& future : pending) future.get();
+
+    // Power operations end the scene, after everything else has been applied
+    run_lane(power);
+
+    bool all_ok = true;
+    result["results"] = json::array();
+    for (size_t i = 0; i < ops.size(); ++i) {
+        json entry;
+        entry["fn"] = ops[i].fn;
+        entry["ok"] = outcomes[i].ok;
+        if (!outcomes[i].ok) {
+            entry["error"] = outcomes[i].error;
+            all_ok = false;
+        }
+        result["results"].push_back(std::move(entry));
+    }
+
+    result["ok"] = all_ok;
+    result["elapsed_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    return result.dump();
+}
+
+} // namespace scene
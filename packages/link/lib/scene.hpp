@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+// Scenes
+//
+// A scene is a JSON list of device and media operations applied in one native
+// call. Operations use the same fn/args as single link commands, e.g. "movie mode":
+//
+//   [{"fn":"brightness","args":{"level":20}},
+//    {"fn":"volume","args":{"level":0.4}},
+//    {"fn":"playMedia"}]
+//
+// Operations are grouped by the resource they touch (audio, display, media,
+// power). Each group runs in order on its own thread and groups run in parallel,
+// so a scene takes as long as its slowest group. Power operations (lock, sleep,
+// shutdown, restart) run last, once everything else has been applied.
+//
+// An operation is ok only when the device or player reported success. The result
+// keeps the input order:
+//
+//   {"ok":true,"elapsed_ms":212,"results":[{"fn":"brightness","ok":true},...]}
+
+namespace scene {
+
+// Device exports the scene runner dispatches to; device_control fills this in
+// with its own exports. Each returns whether the change was applied.
+struct DeviceBackend {
+    bool (*setVolume)(float level);
+    bool (*setMute)(bool shouldMute);
+    bool (*setBrightness)(int level);
+    bool (*lock)();
+    bool (*sleep)();
+    bool (*shutdown)();
+    bool (*restart)();
+};
+
+// Parse and run a scene, returning the result JSON
+std::string run(const char* ops_json, const DeviceBackend& backend);
+
+} // namespace scene
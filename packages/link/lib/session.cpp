@@ -0,0 +1,282 @@
+#include "session.hpp"
+#include "probe.hpp"
+#include "reactor.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+    #include <wtsapi32.h>
+#else
+    #include <sys/inotify.h>
+#endif
+
+namespace session {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+double seconds_since(int64_t ns) {
+    return static_cast<double>(now_ns() - ns) / 1e9;
+}
+
+// Player state written by the track poll, read by hints(). The last-seen time
+// starts at load so media polling stays responsive until the first poll.
+std::atomic<bool> g_playerPresent{false};
+std::atomic<bool> g_playing{false};
+std::atomic<int64_t> g_lastPlayerNs{now_ns()};
+
+struct Presence {
+    bool locked = false;
+    bool idle = false;
+    double idleSeconds = 0;
+};
+
+#if defined(_WIN32) || defined(_WIN64)
+// Lock state of our own session as reported by Terminal Services. Sessions that
+// cannot be queried (or report an unknown state) count as unlocked.
+bool workstation_locked() {
+    LPWSTR buffer = nullptr;
+    DWORD bytes = 0;
+    if (!WTSQuerySessionInformationW(WTS_CURRENT_SERVER_HANDLE, WTS_CURRENT_SESSION, WTSSessionInfoEx,
+                                     &buffer, &bytes)) {
+        return false;
+    }
+
+    bool locked = false;
+    const auto* info = reinterpret_cast<const WTSINFOEXW*>(buffer);
+    if (bytes >= sizeof(WTSINFOEXW) && info->Level == 1) {
+        locked = info->Data.WTSInfoExLevel1.SessionFlags == WTS_SESSIONSTATE_LOCK;
+    }
+    WTSFreeMemory(buffer);
+    return locked;
+}
+
+Presence read_presence() {
+    Presence presence;
+    presence.locked = workstation_locked();
+
+    LASTINPUTINFO info { sizeof(LASTINPUTINFO), 0 };
+    if (GetLastInputInfo(&info)) {
+        presence.idleSeconds = static_cast<double>(GetTickCount() - info.dwTime) / 1000.0;
+    }
+    presence.idle = presence.idleSeconds >= kIdleAfterSeconds;
+    return presence;
+}
+#else
+std::string session_id() {
+    const char* id = std::getenv("XDG_SESSION_ID");
+    return id && *id ? id : "";
+}
+
+// logind's state file for this session; ACTIVE=0 means another session owns the seat
+bool session_inactive(const std::string& id) {
+    if (id.empty()) return false;
+
+    std::ifstream file("/run/systemd/sessions/" + id);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("ACTIVE=", 0) == 0) {
+            return line.compare(7, std::string::npos, "0") == 0;
+        }
+    }
+    return false;
+}
+
+// D-Bus object path of a logind session (sd_bus_path_encode: every byte that is
+// not alphanumeric, and a leading digit, becomes _xx)
+std::string session_object_path(const std::string& id) {
+    std::string path = "/org/freedesktop/login1/session/";
+    for (size_t i = 0; i < id.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(id[i]);
+        const bool digit = c >= '0' && c <= '9';
+        const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        if (alpha || (digit && i > 0)) {
+            path += static_cast<char>(c);
+        } else {
+            char escaped[4];
+            std::snprintf(escaped, sizeof(escaped), "_%02x", c);
+            path += escaped;
+        }
+    }
+    return path;
+}
+
+// Parse `loginctl show-session -p LockedHint -p IdleHint -p IdleSinceHintMonotonic`
+Presence parse_logind(const std::string& output) {
+    Presence presence;
+    bool idle_hint = false;
+    double idle_since_us = 0;
+
+    std::istringstream stream(output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.rfind("LockedHint=", 0) == 0) presence.locked = line.compare(11, 3, "yes") == 0;
+        else if (line.rfind("IdleHint=", 0) == 0) idle_hint = line.compare(9, 3, "yes") == 0;
+        else if (line.rfind("IdleSinceHintMonotonic=", 0) == 0) idle_since_us = std::atof(line.c_str() + 23);
+    }
+
+    if (idle_hint) {
+        presence.idle = true;
+        // IdleSinceHintMonotonic is CLOCK_MONOTONIC, which steady_clock uses on Linux
+        if (idle_since_us > 0) {
+            presence.idleSeconds = static_cast<double>(now_ns()) / 1e9 - idle_since_us / 1e6;
+        }
+    }
+    return presence;
+}
+
+std::mutex g_presenceMutex;
+Presence g_presence;
+std::atomic<bool> g_refreshPending{false};
+bool g_hasLoginctl = false;
+
+// Fallback polling interval (reactor thread only); grows while nothing changes
+double g_pollSeconds = kLogindRefreshSeconds;
+
+// LockedHint and IdleHint are only exposed over D-Bus, so ask loginctl. Runs
+// without blocking the reactor, and only when logind reports a change (or on the
+// fallback poll when changes cannot be followed). done, if set, gets whether the
+// presence changed.
+void refresh_presence(std::function<void(bool)> done = nullptr) {
+    const std::string id = session_id();
+
+    auto store = [id, done = std::move(done)](Presence presence) {
+        presence.locked = presence.locked || session_inactive(id);
+
+        bool changed;
+        {
+            std::lock_guard<std::mutex> lock(g_presenceMutex);
+            changed = presence.locked != g_presence.locked || presence.idle != g_presence.idle;
+            g_presence = presence;
+        }
+        if (done) done(changed);
+    };
+
+    if (!g_hasLoginctl) {
+        store(Presence{});
+        return;
+    }
+
+    reactor::capture({"loginctl", "show-session", id.empty() ? std::string("auto") : id,
+                      "-p", "LockedHint", "-p", "IdleHint", "-p", "IdleSinceHintMonotonic"},
+                     [store](int code, const std::string& output) {
+                         store(code == 0 ? parse_logind(output) : Presence{});
+                     });
+}
+
+// Lock/unlock and seat switches rewrite several session files and emit several
+// property changes at once
+void presence_changed() {
+    if (g_refreshPending.exchange(true)) return;
+    reactor::schedule(100, [] {
+        g_refreshPending = false;
+        refresh_presence();
+    });
+}
+
+// Without a D-Bus monitor, poll: every kLogindRefreshSeconds after a change,
+// backing off to kLogindMaxRefreshSeconds while the state is stable
+void poll_presence() {
+    refresh_presence([](bool changed) {
+        g_pollSeconds = changed ? kLogindRefreshSeconds : std::min(g_pollSeconds * 2, kLogindMaxRefreshSeconds);
+        reactor::schedule(static_cast<uint32_t>(g_pollSeconds * 1000), poll_presence);
+    });
+}
+
+// A monitor that keeps exiting (no system bus) is retried this rarely
+constexpr uint32_t kMonitorRestartMs = 30000;
+
+// Follow logind's PropertiesChanged signals for this session (any session when
+// the id is unknown) and re-query only when one arrives
+void follow_logind() {
+    const std::string id = session_id();
+    const std::string prefix = id.empty() ? session_object_path("") : session_object_path(id) + ":";
+
+    reactor::follow_process(
+        {"gdbus", "monitor", "--system", "--dest", "org.freedesktop.login1"},
+        [prefix](const std::string& line) {
+            if (line.rfind(prefix, 0) != 0 || line.find("PropertiesChanged") == std::string::npos) return;
+            if (line.find("Hint") != std::string::npos || line.find("'Active'") != std::string::npos) {
+                presence_changed();
+            }
+        },
+        // Changes may have been missed while the monitor was down
+        presence_changed,
+        kMonitorRestartMs);
+}
+
+Presence read_presence() {
+    static std::once_flag started;
+    std::call_once(started, [] {
+        g_hasLoginctl = probe::has_executable("loginctl");
+        if (g_hasLoginctl && probe::has_executable("gdbus")) {
+            reactor::post([] { refresh_presence(); });
+            follow_logind();
+        } else {
+            reactor::post(poll_presence);
+        }
+        reactor::add_watch("/run/systemd/sessions", IN_CLOSE_WRITE | IN_MOVED_TO,
+                           [](uint32_t) { presence_changed(); });
+    });
+
+    std::lock_guard<std::mutex> lock(g_presenceMutex);
+    return g_presence;
+}
+#endif
+
+} // namespace
+
+void note_player(bool present, bool playing) {
+    g_playerPresent.store(present, std::memory_order_relaxed);
+    g_playing.store(present && playing, std::memory_order_relaxed);
+    if (present) {
+        g_lastPlayerNs.store(now_ns(), std::memory_order_relaxed);
+    }
+}
+
+Hints hints() {
+    Hints result;
+    const Presence presence = read_presence();
+
+    result.locked = presence.locked;
+    result.idle = presence.idle;
+    result.idleSeconds = presence.idleSeconds;
+    result.player = g_playerPresent.load(std::memory_order_relaxed);
+    result.playing = g_playing.load(std::memory_order_relaxed);
+
+    const bool away = result.locked || result.idle;
+    const int64_t last_player = g_lastPlayerNs.load(std::memory_order_relaxed);
+    const bool player_recent = seconds_since(last_player) < kNoPlayerGraceSeconds;
+
+    if (result.playing) {
+        // Track changes still matter for history while away, progress does not
+        result.mediaMs = away ? 5000 : 1000;
+    } else if (result.player || player_recent) {
+        result.mediaMs = away ? 15000 : 3000;
+    } else {
+        result.mediaMs = away ? 60000 : 10000;
+    }
+
+    result.deviceMs = away ? 60000 : 10000;
+
+    // Core uses heartbeats for presence, so they never back off
+    result.heartbeatMs = 30000;
+    return result;
+}
+
+} // namespace session
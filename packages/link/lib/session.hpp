@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+// Session state
+//
+// Tracks whether anyone is around to see updates (screen lock, input idle) and
+// whether there is anything to report (a player exists, playback is active), and
+// turns that into recommended polling intervals for the link. Querying the hints
+// is cheap enough to do every second: no process is spawned on Windows, and on
+// Linux hints() only reads a cached answer. The cache is refreshed from loginctl
+// (asynchronously, on the reactor) when `gdbus monitor` reports a logind property
+// change or a session file changes; without gdbus it is polled, backing off while
+// the state is stable.
+
+namespace session {
+
+// How long without input (or with logind's IdleHint set) counts as idle
+constexpr double kIdleAfterSeconds = 300.0;
+
+// How long after the last player disappeared before media polling backs off
+constexpr double kNoPlayerGraceSeconds = 60.0;
+
+// Fallback logind polling interval after a change, and its ceiling while stable
+constexpr double kLogindRefreshSeconds = 5.0;
+constexpr double kLogindMaxRefreshSeconds = 60.0;
+
+struct Hints {
+    bool locked = false;
+    bool idle = false;
+    double idleSeconds = 0;
+    bool player = false;
+    bool playing = false;
+    uint32_t mediaMs = 1000;
+    uint32_t deviceMs = 10000;
+    uint32_t heartbeatMs = 30000;
+};
+
+// Record the player state seen by the latest track poll or player event
+void note_player(bool present, bool playing);
+
+// Current session state and the polling intervals it calls for
+Hints hints();
+
+} // namespace session
@@ -0,0 +1,251 @@
+#include "trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace trace {
+
+namespace detail {
+bool g_enabled = false;
+}
+
+namespace {
+
+// Per-thread ring size; the oldest events are overwritten once it is full
+constexpr uint64_t kEventsPerThread = 1 << 13;
+
+struct Event {
+    const char* name;
+    const char* category;
+    int64_t ts_ns;
+    uint32_t tid;
+    char phase;
+};
+
+// Written only by its owning thread; head is published with release so a dump
+// sees complete events up to it. tid and in_use change only under the registry
+// mutex, when the buffer is handed to a new thread.
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    bool in_use = true;
+    std::atomic<uint64_t> head{0};
+    Event events[kEventsPerThread];
+};
+
+std::mutex g_registryMutex;
+std::vector<ThreadBuffer*> g_buffers;
+std::vector<std::pair<uint32_t, const char*>> g_threadNames;
+std::atomic<int64_t> g_sinceNs{0};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t os_thread_id() {
+#if defined(_WIN32) || defined(_WIN64)
+    return static_cast<uint32_t>(GetCurrentThreadId());
+#else
+    return static_cast<uint32_t>(syscall(SYS_gettid));
+#endif
+}
+
+uint32_t os_process_id() {
+#if defined(_WIN32) || defined(_WIN64)
+    return static_cast<uint32_t>(GetCurrentProcessId());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// Buffers are handed out on a thread's first event and returned when the thread
+// exits; the next new thread continues the same ring. The registry therefore only
+// grows to the largest number of threads recording at once (short-lived scene
+// lanes share a few buffers), and events carry their own thread id so earlier
+// owners still show up in dumps until overwritten.
+ThreadBuffer* acquire_buffer() {
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (ThreadBuffer* buffer : g_buffers) {
+        if (buffer->in_use) continue;
+        buffer->in_use = true;
+        buffer->tid = os_thread_id();
+        return buffer;
+    }
+
+    auto* created = new ThreadBuffer();
+    created->tid = os_thread_id();
+    g_buffers.push_back(created);
+    return created;
+}
+
+struct BufferOwner {
+    ThreadBuffer* buffer = acquire_buffer();
+
+    ~BufferOwner() {
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        buffer->in_use = false;
+    }
+};
+
+ThreadBuffer& local_buffer() {
+    thread_local BufferOwner owner;
+    return *owner.buffer;
+}
+
+void record(const char* name, const char* category, char phase) {
+    ThreadBuffer& buffer = local_buffer();
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+    Event& event = buffer.events[head % kEventsPerThread];
+    event.name = name;
+    event.category = category;
+    event.ts_ns = now_ns();
+    event.tid = buffer.tid;
+    event.phase = phase;
+
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+// Events of one ring that are still intact, oldest first
+std::vector<Event> snapshot(const ThreadBuffer& buffer) {
+    uint64_t head = buffer.head.load(std::memory_order_acquire);
+    uint64_t first = head > kEventsPerThread ? head - kEventsPerThread : 0;
+
+    std::vector<Event> events;
+    events.reserve(static_cast<size_t>(head - first));
+    for (uint64_t i = first; i < head; ++i) {
+        events.push_back(buffer.events[i % kEventsPerThread]);
+    }
+
+    // Anything the owner lapped while we copied may be torn
+    uint64_t after = buffer.head.load(std::memory_order_acquire);
+    uint64_t intact = after > kEventsPerThread ? after - kEventsPerThread : 0;
+    if (intact > first) {
+        size_t torn = static_cast<size_t>(std::min<uint64_t>(intact - first, events.size()));
+        events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(torn));
+    }
+    return events;
+}
+
+void append_string(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text ? text : ""; *c; ++c) {
+        if (*c == '"' || *c == '\\') out += '\\';
+        out += *c;
+    }
+    out += '"';
+}
+
+} // namespace
+
+void set_enabled(bool on) {
+    if (on) g_sinceNs.store(now_ns(), std::memory_order_relaxed);
+#if defined(_MSC_VER)
+    *static_cast<volatile bool*>(&detail::g_enabled) = on;
+#else
+    __atomic_store_n(&detail::g_enabled, on, __ATOMIC_RELEASE);
+#endif
+}
+
+void begin(const char* name, const char* category) {
+    record(name, category, 'B');
+}
+
+void end(const char* name, const char* category) {
+    record(name, category, 'E');
+}
+
+void name_thread(const char* name) {
+    const uint32_t tid = os_thread_id();
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+    for (auto& entry : g_threadNames) {
+        if (entry.first == tid) {
+            entry.second = name;
+            return;
+        }
+    }
+    g_threadNames.emplace_back(tid, name);
+}
+
+std::string dump() {
+    // Held throughout so no buffer is reset for a new thread mid-copy
+    std::lock_guard<std::mutex> lock(g_registryMutex);
+
+    const int64_t since = g_sinceNs.load(std::memory_order_relaxed);
+    const std::string pid = std::to_string(os_process_id());
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separate = [&] {
+        if (!first) out += ',';
+        first = false;
+    };
+
+    for (const auto& [tid, name] : g_threadNames) {
+        separate();
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + std::to_string(tid) + ",\"args\":{\"name\":";
+        append_string(out, name);
+        out += "}}";
+    }
+
+    for (const ThreadBuffer* buffer : g_buffers) {
+        for (const Event& event : snapshot(*buffer)) {
+            if (event.ts_ns < since) continue;
+
+            // Chrome traces use microseconds
+            char ts[32];
+            std::snprintf(ts, sizeof(ts), "%.3f", static_cast<double>(event.ts_ns - since) / 1000.0);
+
+            separate();
+            out += "{\"name\":";
+            append_string(out, event.name);
+            out += ",\"cat\":";
+            append_string(out, event.category);
+            out += ",\"ph\":\"";
+            out += event.phase;
+            out += "\",\"ts\":";
+            out += ts;
+            out += ",\"pid\":" + pid + ",\"tid\":" + std::to_string(event.tid) + "}";
+        }
+    }
+
+    out += "]}";
+    return out;
+}
+
+} // namespace trace
+
+// FFI Exports
+extern "C" {
+    // Turn tracing on (starting a new capture) or off; returns the new state
+    LINK_RUNTIME_API bool setTracing(bool enabled) {
+        trace::set_enabled(enabled);
+        return trace::enabled();
+    }
+
+    // The current capture in Chrome Trace Event format
+    LINK_RUNTIME_API const char* dumpTrace() {
+        static std::string result_json;
+        static std::mutex result_mutex;
+
+        std::string trace_json = trace::dump();
+
+        std::lock_guard<std::mutex> lock(result_mutex);
+        result_json = std::move(trace_json);
+        return result_json.c_str();
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+
+#include "runtime_api.hpp"
+
+// Tracer
+//
+// Opt-in begin/end events for exports and backend sub-steps, dumped in Chrome
+// Trace Event format (loadable in Perfetto or chrome://tracing). Each thread
+// appends to its own fixed ring, so recording takes no lock; the dump copies the
+// rings without stopping writers and drops anything overwritten while copying.
+//
+// While disabled, TRACE_SCOPE costs one relaxed load and branch. Names and
+// categories must be string literals: only the pointers are recorded.
+//
+// The flag is read with compiler intrinsics rather than <atomic> so that
+// device_control.cpp can include this header (see its system commands).
+
+namespace trace {
+
+namespace detail {
+LINK_RUNTIME_API extern bool g_enabled;
+}
+
+inline bool enabled() {
+#if defined(_MSC_VER)
+    return *static_cast<const volatile bool*>(&detail::g_enabled);
+#else
+    return __atomic_load_n(&detail::g_enabled, __ATOMIC_RELAXED);
+#endif
+}
+
+// Start or stop recording. Enabling starts a fresh capture: earlier events are
+// left out of later dumps.
+LINK_RUNTIME_API void set_enabled(bool on);
+
+LINK_RUNTIME_API void begin(const char* name, const char* category);
+LINK_RUNTIME_API void end(const char* name, const char* category);
+
+// Label the calling thread in dumps
+LINK_RUNTIME_API void name_thread(const char* name);
+
+// Events of the current capture as a Chrome trace JSON object
+LINK_RUNTIME_API std::string dump();
+
+class Scope {
+public:
+    Scope(const char* name, const char* category) : name(name), category(category), active(enabled()) {
+        if (active) begin(name, category);
+    }
+
+    ~Scope() {
+        if (active) end(name, category);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    bool active;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// Record the enclosing block as one slice
+#define TRACE_SCOPE(name, category) trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
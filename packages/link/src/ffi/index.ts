@@ -24,6 +24,18 @@ function getLibraryPath(libName: string): string {
 	}
 }
 
+/**
+ * Shared runtime FFI bindings
+ *
+ * Both libraries below link against link_runtime (the reactor thread and tracer
+ * they share), so it is loaded first from the same build directory.
+ */
+export const linkRuntime = dlopen(getLibraryPath('link_runtime'), {
+	getReactorStats: { args: [], returns: FFIType.cstring },
+	setTracing: { args: [FFIType.bool], returns: FFIType.bool },
+	dumpTrace: { args: [], returns: FFIType.cstring },
+});
+
 /**
  * Media control FFI bindings
  */
@@ -34,6 +46,10 @@ export const mediaControlLib = dlopen(getLibraryPath('media_control'), {
 	previousTrack: { args: [], returns: FFIType.bool },
 	seekTo: { args: [FFIType.cstring], returns: FFIType.bool },
 	getCurrentTrackInfo: { args: [], returns: FFIType.cstring },
+	openPlaybackLog: { args: [FFIType.cstring], returns: FFIType.bool },
+	readPlaybackHistory: { args: [FFIType.u64, FFIType.u32], returns: FFIType.cstring },
+	getCapabilities: { args: [], returns: FFIType.cstring },
+	getPollingHints: { args: [], returns: FFIType.cstring },
 });
 
 /**
@@ -41,12 +57,14 @@ export const mediaControlLib = dlopen(getLibraryPath('media_control'), {
  */
 export const deviceControl = dlopen(getLibraryPath('device_control'), {
 	getVolume: { args: [], returns: FFIType.f32 },
-	volume: { args: [FFIType.f32], returns: FFIType.void },
-	mute: { args: [FFIType.bool], returns: FFIType.void },
+	volume: { args: [FFIType.f32], returns: FFIType.bool },
+	mute: { args: [FFIType.bool], returns: FFIType.bool },
 	getBrightness: { args: [], returns: FFIType.i32 },
-	brightness: { args: [FFIType.i32], returns: FFIType.void },
-	lock: { args: [], returns: FFIType.void },
-	sleep: { args: [], returns: FFIType.void },
-	shutdown: { args: [], returns: FFIType.void },
-	restart: { args: [], returns: FFIType.void },
+	brightness: { args: [FFIType.i32], returns: FFIType.bool },
+	lock: { args: [], returns: FFIType.bool },
+	sleep: { args: [], returns: FFIType.bool },
+	shutdown: { args: [], returns: FFIType.bool },
+	restart: { args: [], returns: FFIType.bool },
+	getCapabilities: { args: [], returns: FFIType.cstring },
+	runScene: { args: [FFIType.cstring], returns: FFIType.cstring },
 });
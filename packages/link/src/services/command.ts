@@ -1,7 +1,7 @@
 /**
  * External Dependencies
  */
-import { $, env } from 'bun';
+import { $, env, write } from 'bun';
 
 /**
  * Yumi Internal Packages
@@ -12,7 +12,7 @@ import { Result } from '@yumi/results';
 /**
  * Local Module Imports
  */
-import { deviceControl, mediaControlLib } from '../ffi';
+import { deviceControl, linkRuntime, mediaControlLib } from '../ffi';
 import { CommandError } from './command.error';
 
 export interface TrackInfo {
@@ -24,11 +24,75 @@ export interface TrackInfo {
 	positionFormatted: string;
 	playback_status: 'playing' | 'paused' | 'stopped';
 	artwork?: string | null; // undefined = not included, null = clear, string = data URL
+	palette?: ArtworkPalette | null; // null = no artwork or no palette on this platform
+}
+
+export interface ArtworkPalette {
+	dominant: string; // #rrggbb
+	accent: string; // #rrggbb
+	colors: Array<{ color: string; weight: number }>; // heaviest first, weight = share of the artwork
+}
+
+export interface Capabilities {
+	media: boolean;
+	palette: boolean;
+	volume: boolean;
+	brightness: boolean;
+	power: boolean;
+}
+
+export interface PollingHints {
+	locked: boolean;
+	idle: boolean;
+	idle_seconds: number;
+	player: boolean;
+	playing: boolean;
+	media_ms: number;
+	device_ms: number;
+	heartbeat_ms: number;
+}
+
+export interface SceneOperation {
+	fn: string;
+	args?: Record<string, unknown>;
+}
+
+export interface SceneResult {
+	ok: boolean;
+	elapsed_ms: number;
+	results: Array<{ fn: string; ok: boolean; error?: string }>;
+}
+
+export interface PlaybackRecord {
+	seq: number;
+	event: 'track' | 'status' | 'seek';
+	monotonic_ns: number;
+	time: number;
+	track: string;
+	title: string;
+	artist: string;
+	status: string;
+	position_ms: number;
+}
+
+export interface PlaybackHistoryBatch {
+	cursor: number;
+	dropped: number;
+	records: PlaybackRecord[];
 }
 
 export class CommandService extends Singleton {
 	protected constructor() {
 		super();
+
+		const logPath = (env.YUMI_PLAYBACK_LOG || 'playback.ring') + '\0';
+		if (!mediaControlLib.symbols.openPlaybackLog(Buffer.from(logPath, 'utf-8'))) {
+			console.warn('Failed to open playback history log, listening history is disabled');
+		}
+
+		if (env.YUMI_TRACE === '1') {
+			this.setTracing(true);
+		}
 	}
 
 	/**
@@ -62,6 +126,11 @@ export class CommandService extends Singleton {
 		if (fn === 'getCurrentTrackInfo') {
 			return this.getCurrentTrack();
 		}
+		if (fn === 'getPlaybackHistory') {
+			const cursor = typeof args?.cursor === 'number' ? args.cursor : 0;
+			const limit = typeof args?.limit === 'number' ? args.limit : 0;
+			return this.getPlaybackHistory(cursor, limit);
+		}
 		if (fn === 'searchPlayYoutube') {
 			const query = args?.query as string;
 			if (!query) return Result.err(CommandError.InvalidCommand('searchPlayYoutube requires query'));
@@ -102,6 +171,26 @@ export class CommandService extends Singleton {
 		if (fn === 'getDeviceState') {
 			return this.getDeviceState();
 		}
+		if (fn === 'getCapabilities') {
+			return this.getCapabilities();
+		}
+		if (fn === 'runScene') {
+			const ops = args?.ops;
+			if (!Array.isArray(ops)) return Result.err(CommandError.InvalidCommand('runScene requires ops array'));
+			return this.runScene(ops as SceneOperation[]);
+		}
+
+		// Diagnostics
+		if (fn === 'setTracing') {
+			const enabled = args?.enabled;
+			if (typeof enabled !== 'boolean') {
+				return Result.err(CommandError.InvalidCommand('setTracing requires enabled boolean'));
+			}
+			return this.setTracing(enabled);
+		}
+		if (fn === 'dumpTrace') {
+			return this.dumpTrace();
+		}
 
 		return Result.err(CommandError.InvalidCommand(fn));
 	}
@@ -176,6 +265,7 @@ export class CommandService extends Singleton {
 					positionFormatted: trackInfo.current_position || '0:00',
 					playback_status: trackInfo.playback_status || 'stopped',
 					artwork,
+					palette: trackInfo.palette ?? null,
 				};
 
 				return Result.ok(result);
@@ -202,6 +292,55 @@ export class CommandService extends Singleton {
 		}
 	}
 
+	/**
+	 * Get the native session state and the polling intervals it recommends.
+	 * Cheap enough to call every second: no media or device backend is queried.
+	 * @returns Result with lock/idle/player state and intervals in milliseconds
+	 */
+	public getPollingHints(): Result<PollingHints, CommandError> {
+		try {
+			const json = mediaControlLib.symbols.getPollingHints();
+			const hints = JSON.parse(json as unknown as string);
+
+			if (hints.error) {
+				return Result.err(CommandError.FFIError(hints.error));
+			}
+
+			return Result.ok(hints as PollingHints);
+		} catch (error) {
+			return Result.err(
+				CommandError.FFIError(
+					error instanceof Error ? error.message : 'Failed to get polling hints',
+				),
+			);
+		}
+	}
+
+	/**
+	 * Drain playback history records written since `cursor`
+	 * @param cursor - Cursor returned by the previous batch (0 to start from the oldest record)
+	 * @param limit - Maximum records to return (0 uses the native batch limit)
+	 * @returns The batch and the cursor to resume from
+	 */
+	public getPlaybackHistory(cursor = 0, limit = 0): Result<PlaybackHistoryBatch, CommandError> {
+		try {
+			const json = mediaControlLib.symbols.readPlaybackHistory(BigInt(cursor), limit);
+			const batch = JSON.parse(json as unknown as string);
+
+			if (batch.error) {
+				return Result.err(CommandError.FFIError(batch.error));
+			}
+
+			return Result.ok(batch as PlaybackHistoryBatch);
+		} catch (error) {
+			return Result.err(
+				CommandError.FFIError(
+					error instanceof Error ? error.message : 'Failed to read playback history',
+				),
+			);
+		}
+	}
+
 	private async searchPlayYoutube(query: string): Promise<Result<boolean, CommandError>> {
 		return await this.sendNativeMessage({
 			action: 'playSong',
@@ -229,7 +368,9 @@ export class CommandService extends Singleton {
 				);
 			}
 			const normalizedVolume = volume / 100;
-			deviceControl.symbols.volume(normalizedVolume);
+			if (!deviceControl.symbols.volume(normalizedVolume)) {
+				return Result.err(CommandError.CommandExecutionFailed('setVolume'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('setVolume'));
@@ -243,7 +384,9 @@ export class CommandService extends Singleton {
 					CommandError.InvalidCommand('Invalid brightness value. Must be between 0 and 100.'),
 				);
 			}
-			deviceControl.symbols.brightness(brightness);
+			if (!deviceControl.symbols.brightness(brightness)) {
+				return Result.err(CommandError.CommandExecutionFailed('setBrightness'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('setBrightness'));
@@ -252,7 +395,9 @@ export class CommandService extends Singleton {
 
 	private mute(enabled: boolean): Result<boolean, CommandError> {
 		try {
-			deviceControl.symbols.mute(enabled);
+			if (!deviceControl.symbols.mute(enabled)) {
+				return Result.err(CommandError.CommandExecutionFailed('mute'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('mute'));
@@ -261,7 +406,9 @@ export class CommandService extends Singleton {
 
 	private lock(): Result<boolean, CommandError> {
 		try {
-			deviceControl.symbols.lock();
+			if (!deviceControl.symbols.lock()) {
+				return Result.err(CommandError.CommandExecutionFailed('lock'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('lock'));
@@ -270,7 +417,9 @@ export class CommandService extends Singleton {
 
 	private sleep(): Result<boolean, CommandError> {
 		try {
-			deviceControl.symbols.sleep();
+			if (!deviceControl.symbols.sleep()) {
+				return Result.err(CommandError.CommandExecutionFailed('sleep'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('sleep'));
@@ -279,7 +428,9 @@ export class CommandService extends Singleton {
 
 	private shutdown(): Result<boolean, CommandError> {
 		try {
-			deviceControl.symbols.shutdown();
+			if (!deviceControl.symbols.shutdown()) {
+				return Result.err(CommandError.CommandExecutionFailed('shutdown'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('shutdown'));
@@ -288,13 +439,97 @@ export class CommandService extends Singleton {
 
 	private restart(): Result<boolean, CommandError> {
 		try {
-			deviceControl.symbols.restart();
+			if (!deviceControl.symbols.restart()) {
+				return Result.err(CommandError.CommandExecutionFailed('restart'));
+			}
 			return Result.ok(true);
 		} catch (error) {
 			return Result.err(CommandError.CommandExecutionFailed('restart'));
 		}
 	}
 
+	/**
+	 * Apply several device and media operations in one native call.
+	 * Operations on different resources run in parallel, power operations run last.
+	 * @param ops - Operations using the same fn/args as single commands
+	 * @returns Result with per-operation status in input order
+	 */
+	public runScene(ops: SceneOperation[]): Result<SceneResult, CommandError> {
+		try {
+			const json = deviceControl.symbols.runScene(Buffer.from(JSON.stringify(ops) + '\0', 'utf-8'));
+			const result = JSON.parse(json as unknown as string);
+
+			if (result.error) {
+				return Result.err(CommandError.InvalidCommand(`runScene: ${result.error}`));
+			}
+
+			return Result.ok(result as SceneResult);
+		} catch (error) {
+			return Result.err(CommandError.CommandExecutionFailed('runScene'));
+		}
+	}
+
+	/**
+	 * Report which features the native backends can serve on this machine.
+	 * Probing happens on the first call and is cached natively.
+	 * @returns Result with the merged media and device capabilities
+	 */
+	public getCapabilities(): Result<Capabilities, CommandError> {
+		try {
+			const media = JSON.parse(mediaControlLib.symbols.getCapabilities() as unknown as string);
+			const device = JSON.parse(deviceControl.symbols.getCapabilities() as unknown as string);
+
+			return Result.ok({
+				media: media.media === true,
+				palette: media.palette === true,
+				volume: device.volume === true,
+				brightness: device.brightness === true,
+				power: device.power === true,
+			});
+		} catch (error) {
+			return Result.err(
+				CommandError.FFIError(
+					error instanceof Error ? error.message : 'Failed to get capabilities',
+				),
+			);
+		}
+	}
+
+	// ─── Diagnostics ─────────────────────────────────────────────────────────
+
+	/**
+	 * Turn native tracing on or off. Enabling starts a new capture.
+	 * @param enabled - Whether exports and backend steps should be recorded
+	 * @returns Result with the tracing state now in effect
+	 */
+	public setTracing(enabled: boolean): Result<boolean, CommandError> {
+		try {
+			return Result.ok(linkRuntime.symbols.setTracing(enabled));
+		} catch (error) {
+			return Result.err(CommandError.CommandExecutionFailed('setTracing'));
+		}
+	}
+
+	/**
+	 * Write the current native trace capture to disk in Chrome Trace Event format,
+	 * ready to open in Perfetto or chrome://tracing. The file is fixed by local
+	 * configuration (YUMI_TRACE_FILE, or link-trace.json next to the link's other
+	 * data); remote callers cannot choose where it goes.
+	 * @returns Result with the path written
+	 */
+	public async dumpTrace(): Promise<Result<string, CommandError>> {
+		try {
+			const target = env.YUMI_TRACE_FILE || 'link-trace.json';
+			const trace = linkRuntime.symbols.dumpTrace().toString();
+			await write(target, trace);
+			return Result.ok(target);
+		} catch (error) {
+			return Result.err(
+				CommandError.FFIError(error instanceof Error ? error.message : 'Failed to dump trace'),
+			);
+		}
+	}
+
 	// ─── Helper Methods ──────────────────────────────────────────────────────
 
 	private async sendNativeMessage(
@@ -11,7 +11,7 @@ import { Singleton } from '@yumi/patterns';
 /**
  * Local Module Imports
  */
-import { CommandService, type TrackInfo } from './command';
+import { CommandService, type ArtworkPalette, type Capabilities, type TrackInfo } from './command';
 import type { DeviceData } from '../db/type';
 
 // WS Message Types (matching core package)
@@ -22,6 +22,7 @@ enum WSType {
 	Ack = 'ack',
 	Heartbeat = 'heartbeat',
 	DeviceState = 'deviceState',
+	ControlResult = 'controlResult',
 }
 
 type DeviceWSData = {
@@ -31,6 +32,7 @@ type DeviceWSData = {
 		type: string;
 		name: string;
 		identifier: string;
+		capabilities?: Capabilities;
 	};
 };
 
@@ -45,6 +47,7 @@ type MusicWSData = {
 		positionFormatted?: string;
 		status?: 'playing' | 'paused' | 'stopped';
 		artwork?: string | null; // undefined = omit, null = clear, string = data URL
+		palette?: ArtworkPalette | null;
 		hash: string;
 	};
 };
@@ -55,6 +58,19 @@ type ControlWSData = {
 		fn: string;
 		args?: Record<string, unknown>;
 		hash: string;
+		id?: string; // set when the sender waits for a ControlResult
+	};
+};
+
+type ControlResultWSData = {
+	type: WSType.ControlResult;
+	data: {
+		id: string;
+		fn: string;
+		ok: boolean;
+		result?: unknown;
+		error?: string;
+		hash: string;
 	};
 };
 
@@ -78,7 +94,17 @@ type AckWSData = {
 	type: WSType.Ack;
 };
 
-type WSData = DeviceWSData | MusicWSData | ControlWSData | AckWSData | HeartbeatWSData | DeviceStateWSData;
+// How often the native polling hints are checked
+const POLL_TICK_MS = 1000;
+
+type WSData =
+	| DeviceWSData
+	| MusicWSData
+	| ControlWSData
+	| ControlResultWSData
+	| AckWSData
+	| HeartbeatWSData
+	| DeviceStateWSData;
 
 export class WebSocketClient extends Singleton {
 	private ws: WebSocket | null = null;
@@ -86,8 +112,9 @@ export class WebSocketClient extends Singleton {
 	private commandService: CommandService;
 	private reconnectTimer: Timer | null = null;
 	private heartbeatInterval: Timer | null = null;
-	private musicUpdateInterval: Timer | null = null;
-	private deviceStateInterval: Timer | null = null;
+	private pollInterval: Timer | null = null;
+	private lastMusicUpdate = 0;
+	private lastDeviceStateUpdate = 0;
 	private serverUrl: string;
 	private isConnected = false;
 
@@ -133,9 +160,7 @@ export class WebSocketClient extends Singleton {
 				this.isConnected = true;
 				this.#registerDevice();
 				this.#startHeartbeat();
-				this.#startMusicUpdates();
-				this.#sendDeviceState(); // Send initial state
-				this.#startDeviceStateUpdates();
+				this.#startPolling(); // Sends initial music and device state on the first tick
 			};
 
 			this.ws.onmessage = (event) => {
@@ -161,6 +186,8 @@ export class WebSocketClient extends Singleton {
 	#registerDevice(): void {
 		if (!this.device) return;
 
+		const capabilities = this.commandService.getCapabilities();
+
 		const message: DeviceWSData = {
 			type: WSType.Device,
 			data: {
@@ -168,6 +195,7 @@ export class WebSocketClient extends Singleton {
 				type: this.device.type,
 				name: this.device.name,
 				identifier: env.YUMI_LINK_IDENTIFIER!,
+				capabilities: capabilities.isOk() ? capabilities.unwrap()! : undefined,
 			},
 		};
 
@@ -191,33 +219,66 @@ export class WebSocketClient extends Singleton {
 		}, 30000);
 	}
 
-	#startMusicUpdates(): void {
-		// Send music updates every 5 seconds
-		this.musicUpdateInterval = setInterval(async () => {
+	#startPolling(): void {
+		// Check the native polling hints every tick and only query media / device
+		// state once their recommended interval has elapsed. Intervals back off while
+		// the session is locked, idle or has no player, and shrink again on the next
+		// tick after activity resumes.
+		this.lastMusicUpdate = 0;
+		this.lastDeviceStateUpdate = 0;
+
+		const poll = () => {
 			if (!this.device || !this.isConnected) return;
 
-			const trackResult = this.commandService.getCurrentTrack();
-			if (trackResult.isErr()) return;
+			const hintsResult = this.commandService.getPollingHints();
+			const hints = hintsResult.isOk() ? hintsResult.unwrap()! : null;
+			const mediaMs = hints?.media_ms ?? 1000;
+			const deviceMs = hints?.device_ms ?? 10000;
 
-			const track = trackResult.unwrap()!;
+			// Half a tick of slack so a 1s interval is not skipped on timer jitter
+			const now = Date.now();
+			const slack = POLL_TICK_MS / 2;
 
-			const message: MusicWSData = {
-				type: WSType.Music,
-				data: {
-					title: track.title,
-					artist: track.artist,
-					duration: track.duration,
-					position: track.position,
-					durationFormatted: track.durationFormatted,
-					positionFormatted: track.positionFormatted,
-					status: track.playback_status,
-					artwork: track.artwork,
-					hash: this.device.hash,
-				},
-			};
+			if (now - this.lastMusicUpdate >= mediaMs - slack) {
+				this.lastMusicUpdate = now;
+				this.#sendMusicUpdate();
+			}
 
-			this.#send(message);
-		}, 1000);
+			if (now - this.lastDeviceStateUpdate >= deviceMs - slack) {
+				this.lastDeviceStateUpdate = now;
+				this.#sendDeviceState();
+			}
+		};
+
+		poll();
+		this.pollInterval = setInterval(poll, POLL_TICK_MS);
+	}
+
+	#sendMusicUpdate(): void {
+		if (!this.device || !this.isConnected) return;
+
+		const trackResult = this.commandService.getCurrentTrack();
+		if (trackResult.isErr()) return;
+
+		const track = trackResult.unwrap()!;
+
+		const message: MusicWSData = {
+			type: WSType.Music,
+			data: {
+				title: track.title,
+				artist: track.artist,
+				duration: track.duration,
+				position: track.position,
+				durationFormatted: track.durationFormatted,
+				positionFormatted: track.positionFormatted,
+				status: track.playback_status,
+				artwork: track.artwork,
+				palette: track.palette,
+				hash: this.device.hash,
+			},
+		};
+
+		this.#send(message);
 	}
 
 	#sendDeviceState(): void {
@@ -240,13 +301,6 @@ export class WebSocketClient extends Singleton {
 		this.#send(message);
 	}
 
-	#startDeviceStateUpdates(): void {
-		// Send device state updates every 10 seconds
-		this.deviceStateInterval = setInterval(() => {
-			this.#sendDeviceState();
-		}, 10000);
-	}
-
 	async #handleMessage(data: string | Buffer): Promise<void> {
 		try {
 			const message: WSData = JSON.parse(data.toString());
@@ -262,17 +316,35 @@ export class WebSocketClient extends Singleton {
 	}
 
 	async #handleControlCommand(message: ControlWSData): Promise<void> {
-		const { fn, args } = message.data;
+		const { fn, args, id } = message.data;
 
 		console.log(`Executing command: ${fn}`, args);
 
 		const result = await this.commandService.execute(fn, args);
 
+		// A command is activity: refresh media and device state on the next tick
+		this.lastMusicUpdate = 0;
+		this.lastDeviceStateUpdate = 0;
+
 		if (result.isErr()) {
 			console.error(`Command execution failed: ${result.unwrapErr()!.message}`);
 		} else {
 			console.log(`Command executed successfully: ${fn}`);
 		}
+
+		if (id && this.device) {
+			this.#send({
+				type: WSType.ControlResult,
+				data: {
+					id,
+					fn,
+					ok: result.isOk(),
+					result: result.isOk() ? result.unwrap() : undefined,
+					error: result.isErr() ? result.unwrapErr()!.message : undefined,
+					hash: this.device.hash,
+				},
+			});
+		}
 	}
 
 	#send(message: WSData): void {
@@ -294,14 +366,9 @@ export class WebSocketClient extends Singleton {
 			this.heartbeatInterval = null;
 		}
 
-		if (this.musicUpdateInterval) {
-			clearInterval(this.musicUpdateInterval);
-			this.musicUpdateInterval = null;
-		}
-
-		if (this.deviceStateInterval) {
-			clearInterval(this.deviceStateInterval);
-			this.deviceStateInterval = null;
+		if (this.pollInterval) {
+			clearInterval(this.pollInterval);
+			this.pollInterval = null;
 		}
 
 		if (this.reconnectTimer) {
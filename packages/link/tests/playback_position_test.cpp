@@ -0,0 +1,103 @@
+// Position estimates fed to the playback log while polls are backed off
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "playback_log.hpp"
+#include "playback_position.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+static bool near(double a, double b) {
+    return std::abs(a - b) < 1e-6;
+}
+
+static Clock::time_point at(Clock::time_point start, double seconds) {
+    return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+// Player reports a stale timeline while polls are spaced 3-15 s apart
+static void test_extrapolates_by_elapsed_time() {
+    playback_position::Tracker tracker;
+    const auto start = Clock::now();
+
+    check(near(tracker.update(10, 200, true, start).first, 10), "first report is taken as is");
+    check(near(tracker.update(10, 200, true, at(start, 4.2)).first, 14.2), "advances by 4.2 s after a 4.2 s poll");
+    check(near(tracker.update(10, 200, true, at(start, 19.2)).first, 29.2), "advances by 15 s after a 15 s poll");
+    check(near(tracker.update(31, 200, true, at(start, 20.0)).first, 31), "fresh report replaces the estimate");
+}
+
+static void test_pause_freezes_position() {
+    playback_position::Tracker tracker;
+    const auto start = Clock::now();
+
+    tracker.update(10, 200, true, start);
+    check(near(tracker.update(10, 200, false, at(start, 5)).first, 15), "played until the pause was seen");
+    check(near(tracker.update(10, 200, false, at(start, 20)).first, 15), "stands still while paused");
+    check(near(tracker.update(10, 200, true, at(start, 30)).first, 15), "resumes from the paused position");
+    check(near(tracker.update(10, 200, true, at(start, 33)).first, 18), "advances again after resuming");
+}
+
+static void test_clamps_to_duration() {
+    playback_position::Tracker tracker;
+    const auto start = Clock::now();
+
+    tracker.update(195, 200, true, start);
+    check(near(tracker.update(195, 200, true, at(start, 15)).first, 200), "never runs past the end");
+}
+
+// Slow polls of a steadily playing track must not be logged as seeks
+static void test_slow_polls_log_no_seeks() {
+    const std::string path = (std::filesystem::temp_directory_path() / "playback_position_test.log").string();
+    std::filesystem::remove(path);
+
+    playback_log::PlaybackLog log;
+    check(log.open(path), "log opens");
+
+    playback_position::Tracker tracker;
+    const auto start = Clock::now();
+    const double polls[] = {0, 4.2, 9.2, 24.2, 27.2, 42.2};
+    for (double seconds : polls) {
+        const auto now = at(start, seconds);
+        // The player only ever reports the position it started at
+        double position = tracker.update(10, 300, true, now).first;
+        log.observe("Title", "Artist", "Playing", position, now);
+    }
+
+    // A real seek is still recorded
+    const auto seekAt = at(start, 45.2);
+    log.observe("Title", "Artist", "Playing", tracker.update(200, 300, true, seekAt).first, seekAt);
+
+    nlohmann::json out = log.read(0, 0);
+    check(out["records"].size() == 2, "only the track change and the real seek are logged");
+    if (out["records"].size() == 2) {
+        check(out["records"][0]["event"] == "track", "first record is the track change");
+        check(out["records"][1]["event"] == "seek", "second record is the seek");
+    }
+
+    log.close();
+    std::filesystem::remove(path);
+}
+
+int main() {
+    test_extrapolates_by_elapsed_time();
+    test_pause_freezes_position();
+    test_clamps_to_duration();
+    test_slow_polls_log_no_seeks();
+
+    if (failures) return 1;
+    std::printf("playback_position: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include "dot.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+    #define DOT_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define DOT_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit AVX2 code inside functions that opt in to it
+#if defined(DOT_X86) && !defined(_MSC_VER)
+    #define DOT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+    #define DOT_TARGET_AVX2
+#endif
+
+namespace dot {
+namespace {
+
+float f32_scalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+int32_t i8_scalar(const int8_t* a, const int8_t* b, size_t n) {
+    int32_t sum = 0;
+    for (size_t i = 0; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+#if defined(DOT_X86)
+DOT_TARGET_AVX2 float f32_avx2(const float* a, const float* b, size_t n) {
+    // Four independent accumulators hide the FMA latency
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+    }
+
+    __m256 acc = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+    __m128 lanes = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    lanes = _mm_add_ps(lanes, _mm_movehl_ps(lanes, lanes));
+    lanes = _mm_add_ss(lanes, _mm_shuffle_ps(lanes, lanes, 0x55));
+
+    float sum = _mm_cvtss_f32(lanes);
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+DOT_TARGET_AVX2 int32_t i8_avx2(const int8_t* a, const int8_t* b, size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        // Widen to int16, then multiply-add pairs into int32 lanes
+        __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+    }
+
+    __m128i lanes = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0x4E));
+    lanes = _mm_add_epi32(lanes, _mm_shuffle_epi32(lanes, 0xB1));
+
+    int32_t sum = _mm_cvtsi128_si32(lanes);
+    for (; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    __cpuid(info, 1);
+    const bool fma = (info[2] & (1 << 12)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!fma || !osxsave) return false;
+
+    // The OS must save the YMM registers on context switches
+    if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+#endif
+
+#if defined(DOT_NEON)
+float f32_neon(const float* a, const float* b, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f);
+    float32x4_t acc3 = vdupq_n_f32(0.0f);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        acc2 = vfmaq_f32(acc2, vld1q_f32(a + i + 8), vld1q_f32(b + i + 8));
+        acc3 = vfmaq_f32(acc3, vld1q_f32(a + i + 12), vld1q_f32(b + i + 12));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+    }
+
+    float sum = vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+    for (; i < n; ++i) sum += a[i] * b[i];
+    return sum;
+}
+
+int32_t i8_neon(const int8_t* a, const int8_t* b, size_t n) {
+    int32x4_t acc = vdupq_n_s32(0);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vld1q_s8(a + i);
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+    }
+
+    int32_t sum = vaddvq_s32(acc);
+    for (; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+#endif
+
+Kernels detect() {
+#if defined(DOT_X86)
+    if (cpu_has_avx2()) return {f32_avx2, i8_avx2, "avx2"};
+#elif defined(DOT_NEON)
+    return {f32_neon, i8_neon, "neon"};
+#endif
+    return {f32_scalar, i8_scalar, "scalar"};
+}
+
+} // namespace
+
+const Kernels& best() {
+    static const Kernels kernels = detect();
+    return kernels;
+}
+
+} // namespace dot
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Dot product kernels
+//
+// Float and int8 dot products in three flavours: AVX2+FMA (picked at runtime on
+// x86-64 CPUs that have it, so the library itself needs no -mavx2), NEON on
+// 64-bit ARM, and portable scalar code for everything else.
+
+namespace dot {
+
+using F32Kernel = float (*)(const float* a, const float* b, size_t n);
+using I8Kernel = int32_t (*)(const int8_t* a, const int8_t* b, size_t n);
+
+struct Kernels {
+    F32Kernel f32;
+    I8Kernel i8;
+    const char* name;  // "avx2", "neon" or "scalar"
+};
+
+// Fastest kernels this CPU supports, detected once
+const Kernels& best();
+
+} // namespace dot
@@ -0,0 +1,451 @@
+#include "vector_index.hpp"
+#include "dot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Portable export macro
+#if defined(_WIN32) || defined(_WIN64)
+    #define VECTORINDEX_API extern "C" __declspec(dllexport)
+#else
+    #define VECTORINDEX_API extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace vector_index {
+namespace {
+
+constexpr uint64_t kRowAlign = 64;
+
+// Min-heap order: the weakest kept hit sits at the front
+bool weaker(const Hit& a, const Hit& b) {
+    return a.score > b.score;
+}
+
+void keep(std::vector<Hit>& heap, uint32_t k, Hit hit) {
+    if (heap.size() < k) {
+        heap.push_back(hit);
+        std::push_heap(heap.begin(), heap.end(), weaker);
+    } else if (hit.score > heap.front().score) {
+        std::pop_heap(heap.begin(), heap.end(), weaker);
+        heap.back() = hit;
+        std::push_heap(heap.begin(), heap.end(), weaker);
+    }
+}
+
+// Symmetric per-vector int8 quantization; returns the scale
+float quantize(const float* values, uint32_t dimension, int8_t* out) {
+    float max_abs = 0.0f;
+    for (uint32_t i = 0; i < dimension; ++i) max_abs = std::max(max_abs, std::fabs(values[i]));
+
+    const float scale = max_abs / 127.0f;
+    const float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+    for (uint32_t i = 0; i < dimension; ++i) {
+        out[i] = static_cast<int8_t>(std::lrint(std::clamp(values[i] * inverse, -127.0f, 127.0f)));
+    }
+    return scale;
+}
+
+} // namespace
+
+bool VectorIndex::open(const std::string& file_path, uint32_t dims, bool int8) {
+    std::lock_guard<std::mutex> lock(mutex);
+    unmap();
+    if (dims == 0) return false;
+
+    path = file_path;
+    dimension = dims;
+    quantized = int8;
+    const uint64_t payload = quantized ? dimension : static_cast<uint64_t>(dimension) * sizeof(float);
+    rowStride = (sizeof(RowHeader) + payload + kRowAlign - 1) / kRowAlign * kRowAlign;
+
+    // Read the existing header (if any) before deciding how much to map
+    Header existing {};
+    bool have_header = false;
+#if defined(_WIN32) || defined(_WIN64)
+    file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                       nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER length {};
+    DWORD read = 0;
+    if (GetFileSizeEx(file, &length) && static_cast<uint64_t>(length.QuadPart) >= sizeof(Header) &&
+        ReadFile(file, &existing, sizeof(Header), &read, nullptr) && read == sizeof(Header)) {
+        have_header = true;
+    }
+    const uint64_t current_size = static_cast<uint64_t>(length.QuadPart);
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        unmap();
+        return false;
+    }
+    const uint64_t current_size = static_cast<uint64_t>(st.st_size);
+    if (current_size >= sizeof(Header) && pread(fd, &existing, sizeof(Header), 0) == static_cast<ssize_t>(sizeof(Header))) {
+        have_header = true;
+    }
+#endif
+
+    const bool reusable = have_header && existing.magic == kMagic && existing.version == kVersion &&
+                          existing.dimension == dimension && existing.quantized == (quantized ? 1u : 0u) &&
+                          existing.rowStride == rowStride && existing.count <= existing.capacity &&
+                          existing.capacity > 0 && file_size(existing.capacity) <= current_size;
+
+    if (!map(reusable ? existing.capacity : kInitialCapacity)) {
+        unmap();
+        return false;
+    }
+
+    if (!reusable) {
+        std::memset(header, 0, sizeof(Header));
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->dimension = dimension;
+        header->quantized = quantized ? 1 : 0;
+        header->capacity = kInitialCapacity;
+        header->rowStride = rowStride;
+    }
+
+    rows.clear();
+    rows.reserve(static_cast<size_t>(header->count));
+    for (uint64_t i = 0; i < header->count; ++i) {
+        rows[reinterpret_cast<const RowHeader*>(row(i))->id] = i;
+    }
+    return true;
+}
+
+void VectorIndex::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    unmap();
+}
+
+uint64_t VectorIndex::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return header ? header->count : 0;
+}
+
+uint64_t VectorIndex::ids(int64_t* out, uint64_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!header) return 0;
+
+    const uint64_t count = header->count < capacity ? header->count : capacity;
+    for (uint64_t i = 0; i < count; ++i) {
+        out[i] = reinterpret_cast<const RowHeader*>(row(i))->id;
+    }
+    return count;
+}
+
+bool VectorIndex::add(int64_t id, const float* vector) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return add_locked(id, vector);
+}
+
+uint32_t VectorIndex::add_batch(const int64_t* ids, const float* vectors, uint32_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint32_t stored = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!add_locked(ids[i], vectors + static_cast<size_t>(i) * dimension)) break;
+        ++stored;
+    }
+    return stored;
+}
+
+bool VectorIndex::remove(int64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!header) return false;
+
+    auto it = rows.find(id);
+    if (it == rows.end()) return false;
+
+    const uint64_t index = it->second;
+    const uint64_t last = header->count - 1;
+    rows.erase(it);
+
+    // Keep rows dense: the last row takes the freed slot
+    if (index != last) {
+        std::memcpy(row(index), row(last), rowStride);
+        rows[reinterpret_cast<const RowHeader*>(row(index))->id] = index;
+    }
+    header->count = last;
+    return true;
+}
+
+void VectorIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!header) return;
+    header->count = 0;
+    rows.clear();
+}
+
+std::vector<Hit> VectorIndex::search(const float* query, uint32_t k, float min_score) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Hit> result;
+    if (!header || header->count == 0 || k == 0) return result;
+
+    // Int8 rows are scored against an int8 copy of the query
+    std::vector<int8_t> query_q;
+    float query_scale = 0.0f;
+    if (quantized) {
+        query_q.resize(dimension);
+        query_scale = quantize(query, dimension, query_q.data());
+    }
+
+    const uint64_t count = header->count;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned threads = static_cast<unsigned>(std::min<uint64_t>(
+        {static_cast<uint64_t>(std::min(hardware, kMaxThreads)), (count + kRowsPerThread - 1) / kRowsPerThread}));
+
+    if (threads <= 1) {
+        scan(query, query_q.data(), query_scale, 0, count, k, min_score, result);
+    } else {
+        std::vector<std::vector<Hit>> heaps(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+
+        const uint64_t chunk = (count + threads - 1) / threads;
+        for (unsigned t = 0; t < threads; ++t) {
+            const uint64_t begin = std::min(count, t * chunk);
+            const uint64_t end = std::min(count, begin + chunk);
+            auto work = [&, t, begin, end] {
+                scan(query, query_q.data(), query_scale, begin, end, k, min_score, heaps[t]);
+            };
+            // The calling thread takes the last chunk itself
+            if (t + 1 < threads) workers.emplace_back(work);
+            else work();
+        }
+        for (auto& worker : workers) worker.join();
+
+        for (const auto& heap : heaps) {
+            for (const Hit& hit : heap) keep(result, k, hit);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const Hit& a, const Hit& b) { return a.score > b.score; });
+    return result;
+}
+
+size_t VectorIndex::file_size(uint64_t capacity) const {
+    return static_cast<size_t>(sizeof(Header) + capacity * rowStride);
+}
+
+uint8_t* VectorIndex::row(uint64_t index) const {
+    return base + sizeof(Header) + index * rowStride;
+}
+
+bool VectorIndex::map(uint64_t capacity) {
+    const size_t size = file_size(capacity);
+
+#if defined(_WIN32) || defined(_WIN64)
+    // Creating a mapping larger than the file extends the file
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+                                 static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                 static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+    if (!mapping) return false;
+
+    base = static_cast<uint8_t*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!base) return false;
+#else
+    struct stat st {};
+    if (fstat(fd, &st) != 0) return false;
+    if (static_cast<size_t>(st.st_size) < size && ftruncate(fd, static_cast<off_t>(size)) != 0) return false;
+
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) return false;
+    base = static_cast<uint8_t*>(mapped);
+#endif
+
+    mappedSize = size;
+    header = reinterpret_cast<Header*>(base);
+    return true;
+}
+
+bool VectorIndex::grow() {
+    const uint64_t capacity = header->capacity * 2;
+    release_view();
+    if (!map(capacity)) {
+        unmap();
+        return false;
+    }
+    header->capacity = capacity;
+    return true;
+}
+
+bool VectorIndex::add_locked(int64_t id, const float* vector) {
+    if (!header || !vector) return false;
+
+    auto it = rows.find(id);
+    if (it != rows.end()) {
+        write_row(it->second, id, vector);
+        return true;
+    }
+
+    if (header->count == header->capacity && !grow()) return false;
+
+    const uint64_t index = header->count;
+    write_row(index, id, vector);
+    header->count = index + 1;
+    rows[id] = index;
+    return true;
+}
+
+void VectorIndex::write_row(uint64_t index, int64_t id, const float* vector) {
+    uint8_t* target = row(index);
+    auto* row_header = reinterpret_cast<RowHeader*>(target);
+    row_header->id = id;
+    row_header->reserved = 0;
+
+    uint8_t* payload = target + sizeof(RowHeader);
+    if (quantized) {
+        row_header->scale = quantize(vector, dimension, reinterpret_cast<int8_t*>(payload));
+    } else {
+        row_header->scale = 1.0f;
+        std::memcpy(payload, vector, static_cast<size_t>(dimension) * sizeof(float));
+    }
+}
+
+void VectorIndex::scan(const float* query, const int8_t* query_q, float query_scale,
+                       uint64_t begin, uint64_t end, uint32_t k, float min_score, std::vector<Hit>& heap) const {
+    const dot::Kernels& kernels = dot::best();
+    heap.reserve(k);
+
+    for (uint64_t i = begin; i < end; ++i) {
+        const uint8_t* current = row(i);
+        const auto* row_header = reinterpret_cast<const RowHeader*>(current);
+        const uint8_t* payload = current + sizeof(RowHeader);
+
+        float score;
+        if (quantized) {
+            const int32_t raw = kernels.i8(query_q, reinterpret_cast<const int8_t*>(payload), dimension);
+            score = static_cast<float>(raw) * query_scale * row_header->scale;
+        } else {
+            score = kernels.f32(query, reinterpret_cast<const float*>(payload), dimension);
+        }
+
+        if (score >= min_score) keep(heap, k, Hit{row_header->id, score});
+    }
+}
+
+void VectorIndex::release_view() {
+    header = nullptr;
+#if defined(_WIN32) || defined(_WIN64)
+    if (base) UnmapViewOfFile(base);
+    if (mapping) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if (base) munmap(base, mappedSize);
+#endif
+    base = nullptr;
+    mappedSize = 0;
+}
+
+void VectorIndex::unmap() {
+    release_view();
+    rows.clear();
+#if defined(_WIN32) || defined(_WIN64)
+    if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+#else
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+}
+
+} // namespace vector_index
+
+using vector_index::VectorIndex;
+
+// FFI Exports. Handles come from openIndex and must be released with closeIndex.
+
+// Open (or create) an index file; returns null on failure
+VECTORINDEX_API void* openIndex(const char* path, uint32_t dimension, bool quantized) {
+    try {
+        if (!path) return nullptr;
+        auto* index = new VectorIndex();
+        if (!index->open(path, dimension, quantized)) {
+            delete index;
+            return nullptr;
+        }
+        return index;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error in openIndex: " << ex.what() << std::endl;
+        return nullptr;
+    }
+}
+
+VECTORINDEX_API void closeIndex(void* handle) {
+    delete static_cast<VectorIndex*>(handle);
+}
+
+VECTORINDEX_API uint32_t indexSize(void* handle) {
+    if (!handle) return 0;
+    return static_cast<uint32_t>(static_cast<VectorIndex*>(handle)->size());
+}
+
+// Write up to capacity stored ids into out_ids; returns the number written
+VECTORINDEX_API uint32_t indexIds(void* handle, int64_t* out_ids, uint32_t capacity) {
+    if (!handle || !out_ids) return 0;
+    return static_cast<uint32_t>(static_cast<VectorIndex*>(handle)->ids(out_ids, capacity));
+}
+
+VECTORINDEX_API bool indexAdd(void* handle, int64_t id, const float* vector) {
+    try {
+        return handle && static_cast<VectorIndex*>(handle)->add(id, vector);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error in indexAdd: " << ex.what() << std::endl;
+        return false;
+    }
+}
+
+// vectors holds count embeddings back to back
+VECTORINDEX_API uint32_t indexAddBatch(void* handle, const int64_t* ids, const float* vectors, uint32_t count) {
+    try {
+        if (!handle || !ids || !vectors) return 0;
+        return static_cast<VectorIndex*>(handle)->add_batch(ids, vectors, count);
+    } catch (const std::exception& ex) {
+        std::cerr << "Error in indexAddBatch: " << ex.what() << std::endl;
+        return 0;
+    }
+}
+
+VECTORINDEX_API bool indexRemove(void* handle, int64_t id) {
+    return handle && static_cast<VectorIndex*>(handle)->remove(id);
+}
+
+VECTORINDEX_API void indexClear(void* handle) {
+    if (handle) static_cast<VectorIndex*>(handle)->clear();
+}
+
+// Write up to k hits (best first) into out_ids/out_scores; returns the number written
+VECTORINDEX_API uint32_t indexSearch(void* handle, const float* query, uint32_t k, float min_score,
+                                     int64_t* out_ids, float* out_scores) {
+    try {
+        if (!handle || !query || !out_ids || !out_scores) return 0;
+
+        auto hits = static_cast<VectorIndex*>(handle)->search(query, k, min_score);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            out_ids[i] = hits[i].id;
+            out_scores[i] = hits[i].score;
+        }
+        return static_cast<uint32_t>(hits.size());
+    } catch (const std::exception& ex) {
+        std::cerr << "Error in indexSearch: " << ex.what() << std::endl;
+        return 0;
+    }
+}
+
+// Name of the dot product kernel in use ("avx2", "neon" or "scalar")
+VECTORINDEX_API const char* indexKernel() {
+    return dot::best().name;
+}
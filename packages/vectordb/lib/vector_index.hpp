@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#endif
+
+// Vector index
+//
+// Message embeddings kept as one memory-mapped matrix next to the SQLite
+// database, so search never decodes BLOBs or walks rows in JS. Each row is a
+// 16-byte header (message id, int8 scale) followed by the vector, padded to a
+// 64-byte stride. Rows are unordered: removing one moves the last row into its
+// slot. The file grows by doubling and is only a cache of the database; the
+// TypeScript side rebuilds it whenever the two disagree.
+//
+// With quantization on, vectors are stored as int8 with a per-row scale
+// (4x smaller, int8 dot products) at a small cost in score precision.
+//
+// Search scores every row with the dot kernels from dot.hpp, split across
+// threads for large indexes, and keeps the best k per thread in a min-heap.
+// Embeddings are normalized, so the dot product is the cosine similarity.
+
+namespace vector_index {
+
+constexpr uint32_t kMagic = 0x58495659;  // "YVIX"
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kInitialCapacity = 1024;
+
+// Rows per search thread; smaller indexes are scanned on the calling thread
+constexpr uint64_t kRowsPerThread = 32768;
+constexpr unsigned kMaxThreads = 8;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dimension;
+    uint32_t quantized;
+    uint64_t count;
+    uint64_t capacity;
+    uint64_t rowStride;
+    uint8_t reserved[24];
+};
+static_assert(sizeof(Header) == 64, "Header must stay 64 bytes");
+
+struct RowHeader {
+    int64_t id;
+    float scale;  // int8 rows: value = q * scale
+    uint32_t reserved;
+};
+static_assert(sizeof(RowHeader) == 16, "RowHeader must stay 16 bytes");
+
+struct Hit {
+    int64_t id;
+    float score;
+};
+
+class VectorIndex {
+public:
+    VectorIndex() = default;
+    VectorIndex(const VectorIndex&) = delete;
+    VectorIndex& operator=(const VectorIndex&) = delete;
+    ~VectorIndex() { close(); }
+
+    // Map (and create if needed) the index file. A file written with another
+    // dimension or storage mode is reset rather than misread.
+    bool open(const std::string& path, uint32_t dimension, bool quantized);
+    void close();
+
+    uint64_t size();
+
+    // Write up to capacity stored ids (in row order) into out; returns how many
+    uint64_t ids(int64_t* out, uint64_t capacity);
+
+    // Insert a vector, replacing the one stored for id if any
+    bool add(int64_t id, const float* vector);
+
+    // Insert count vectors laid out back to back; returns how many were stored
+    uint32_t add_batch(const int64_t* ids, const float* vectors, uint32_t count);
+
+    bool remove(int64_t id);
+    void clear();
+
+    // Best k rows scoring at least min_score, highest first
+    std::vector<Hit> search(const float* query, uint32_t k, float min_score);
+
+private:
+    size_t file_size(uint64_t capacity) const;
+    uint8_t* row(uint64_t index) const;
+    bool map(uint64_t capacity);
+    bool grow();
+    bool add_locked(int64_t id, const float* vector);
+    void release_view();
+    void unmap();
+    void write_row(uint64_t index, int64_t id, const float* vector);
+    void scan(const float* query, const int8_t* query_q, float query_scale,
+              uint64_t begin, uint64_t end, uint32_t k, float min_score, std::vector<Hit>& heap) const;
+
+    std::mutex mutex;
+    std::string path;
+    uint32_t dimension = 0;
+    bool quantized = false;
+    uint64_t rowStride = 0;
+    size_t mappedSize = 0;
+    uint8_t* base = nullptr;
+    Header* header = nullptr;
+    std::unordered_map<int64_t, uint64_t> rows;  // id -> row index
+
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+} // namespace vector_index
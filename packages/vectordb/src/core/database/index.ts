@@ -170,6 +170,30 @@ export class ChatDB {
 		}
 	}
 
+	/**
+	 * Fetch messages by id, in the order the ids are given (missing ids are skipped)
+	 */
+	getByIds(ids: number[]): Result<Message[], DBError> {
+		if (ids.length === 0) return Result.ok([]);
+
+		try {
+			const placeholders = ids.map(() => '?').join(', ');
+			const rows = this.db
+				.query(`SELECT id, role, content, embedding, created_at FROM messages WHERE id IN (${placeholders})`)
+				.all(...ids) as MessageRow[];
+
+			const byId = new Map(rows.map((row) => [row.id, row]));
+			const messages = ids.flatMap((id) => {
+				const row = byId.get(id);
+				return row ? [rowToMessage(row)] : [];
+			});
+			return Result.ok(messages);
+		} catch (error) {
+			const msg = error instanceof Error ? error.message : String(error);
+			return Result.err(DBError.QueryFailed(msg));
+		}
+	}
+
 	getRecent(limit: number): Result<Message[], DBError> {
 		try {
 			const rows = this.getRecentStmt.all({ $limit: limit }) as MessageRow[];
@@ -204,6 +228,19 @@ export class ChatDB {
 		}
 	}
 
+	/**
+	 * Ids of every stored message, without loading their content or embeddings
+	 */
+	getIds(): Result<number[], DBError> {
+		try {
+			const rows = this.db.query('SELECT id FROM messages').values() as [number][];
+			return Result.ok(rows.map(([id]) => id));
+		} catch (error) {
+			const msg = error instanceof Error ? error.message : String(error);
+			return Result.err(DBError.QueryFailed(msg));
+		}
+	}
+
 	count(): Result<number, DBError> {
 		try {
 			const row = this.db.prepare('SELECT COUNT(*) as count FROM messages').get() as { count: number };
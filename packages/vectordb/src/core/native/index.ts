@@ -0,0 +1,143 @@
+/**
+ * External Dependencies
+ */
+import { existsSync } from 'node:fs';
+import { resolve } from 'node:path';
+import { dlopen, FFIType, suffix, type Pointer } from 'bun:ffi';
+
+/**
+ * Determine the library path, preferring the Release build like the link package
+ */
+function getLibraryPath(libName: string): string {
+	const prefix = process.platform === 'win32' ? '' : 'lib';
+	const root = resolve(import.meta.dir, '../../..');
+	const basePath = resolve(root, `build/Release/${prefix}${libName}.${suffix}`);
+	const fallbackPath = resolve(root, `build/${prefix}${libName}.${suffix}`);
+
+	return existsSync(basePath) ? basePath : fallbackPath;
+}
+
+function loadLibrary() {
+	try {
+		return dlopen(getLibraryPath('vector_index'), {
+			openIndex: { args: [FFIType.cstring, FFIType.u32, FFIType.bool], returns: FFIType.ptr },
+			closeIndex: { args: [FFIType.ptr], returns: FFIType.void },
+			indexSize: { args: [FFIType.ptr], returns: FFIType.u32 },
+			indexIds: { args: [FFIType.ptr, FFIType.ptr, FFIType.u32], returns: FFIType.u32 },
+			indexAdd: { args: [FFIType.ptr, FFIType.i64, FFIType.ptr], returns: FFIType.bool },
+			indexAddBatch: { args: [FFIType.ptr, FFIType.ptr, FFIType.ptr, FFIType.u32], returns: FFIType.u32 },
+			indexRemove: { args: [FFIType.ptr, FFIType.i64], returns: FFIType.bool },
+			indexClear: { args: [FFIType.ptr], returns: FFIType.void },
+			indexSearch: {
+				args: [FFIType.ptr, FFIType.ptr, FFIType.u32, FFIType.f32, FFIType.ptr, FFIType.ptr],
+				returns: FFIType.u32,
+			},
+			indexKernel: { args: [], returns: FFIType.cstring },
+		});
+	} catch (error) {
+		const msg = error instanceof Error ? error.message : String(error);
+		console.warn(`[vectordb] native index unavailable, using JS search (${msg})`);
+		return null;
+	}
+}
+
+const lib = loadLibrary();
+
+export interface IndexHit {
+	id: number;
+	score: number;
+}
+
+/**
+ * Memory-mapped embedding matrix searched with SIMD dot products (lib/vector_index.hpp).
+ *
+ * The file is a cache of the messages table; callers rebuild it when it drifts.
+ */
+export class NativeIndex {
+	private constructor(
+		private handle: Pointer,
+		private dimension: number,
+	) {}
+
+	/**
+	 * Open (or create) the index file. Returns null when the native library
+	 * is not built or the file cannot be mapped.
+	 */
+	static open(path: string, dimension: number, quantized: boolean): NativeIndex | null {
+		if (!lib) return null;
+
+		const handle = lib.symbols.openIndex(Buffer.from(`${path}\0`), dimension, quantized);
+		if (!handle) {
+			console.warn(`[vectordb] could not open vector index at ${path}`);
+			return null;
+		}
+		return new NativeIndex(handle, dimension);
+	}
+
+	static kernel(): string | null {
+		return lib ? lib.symbols.indexKernel().toString() : null;
+	}
+
+	size(): number {
+		return lib!.symbols.indexSize(this.handle);
+	}
+
+	/**
+	 * Ids of every stored row, in no particular order
+	 */
+	ids(): number[] {
+		const size = this.size();
+		if (size === 0) return [];
+
+		const out = new BigInt64Array(size);
+		const count = lib!.symbols.indexIds(this.handle, out, size);
+		return Array.from(out.subarray(0, count), Number);
+	}
+
+	add(id: number, embedding: Float32Array): boolean {
+		if (embedding.length !== this.dimension) return false;
+		return lib!.symbols.indexAdd(this.handle, id, embedding);
+	}
+
+	addBatch(entries: { id: number; embedding: Float32Array }[]): number {
+		const valid = entries.filter((entry) => entry.embedding.length === this.dimension);
+		if (valid.length === 0) return 0;
+
+		const ids = new BigInt64Array(valid.length);
+		const vectors = new Float32Array(valid.length * this.dimension);
+		valid.forEach((entry, i) => {
+			ids[i] = BigInt(entry.id);
+			vectors.set(entry.embedding, i * this.dimension);
+		});
+		return lib!.symbols.indexAddBatch(this.handle, ids, vectors, valid.length);
+	}
+
+	remove(id: number): boolean {
+		return lib!.symbols.indexRemove(this.handle, id);
+	}
+
+	clear(): void {
+		lib!.symbols.indexClear(this.handle);
+	}
+
+	/**
+	 * Best topK hits scoring at least minScore, highest first
+	 */
+	search(query: Float32Array, topK: number, minScore: number): IndexHit[] {
+		if (query.length !== this.dimension || topK <= 0) return [];
+
+		const ids = new BigInt64Array(topK);
+		const scores = new Float32Array(topK);
+		const count = lib!.symbols.indexSearch(this.handle, query, topK, minScore, ids, scores);
+
+		const hits: IndexHit[] = [];
+		for (let i = 0; i < count; i++) {
+			hits.push({ id: Number(ids[i]), score: scores[i]! });
+		}
+		return hits;
+	}
+
+	close(): void {
+		lib!.symbols.closeIndex(this.handle);
+	}
+}
@@ -3,12 +3,16 @@ import { CONFIG } from '../../config';
 import { DBError } from '../../errors';
 import { type Message, ChatDB } from '../database';
 import { Embedder } from '../embed';
+import { NativeIndex } from '../native';
 
 export interface SearchResult {
 	message: Message;
 	similarity: number;
 }
 
+/** Messages read from SQLite per native batch while the index is repaired */
+const SYNC_CHUNK_SIZE = 1024;
+
 function cosineSimilarity(a: Float32Array, b: Float32Array): number {
 	let dot = 0;
 	for (let i = 0; i < a.length; i++) {
@@ -18,10 +22,77 @@ function cosineSimilarity(a: Float32Array, b: Float32Array): number {
 }
 
 export class SearchEngine {
+	private nativeIndex: NativeIndex | null = null;
+
+	/**
+	 * With an indexPath, search goes through the native vector index and only
+	 * the matching rows are read back from SQLite. Without one (or when the
+	 * native library is not built) every embedding is scanned in JS.
+	 */
 	constructor(
 		private db: ChatDB,
 		private embedder: Embedder,
-	) {}
+		indexPath?: string,
+	) {
+		if (indexPath) {
+			this.nativeIndex = NativeIndex.open(indexPath, CONFIG.embeddingDimension, CONFIG.indexQuantized);
+			this.syncIndex();
+		}
+	}
+
+	/**
+	 * Bring the index in line with the database after a first run, a crash
+	 * between the two writes or a switch of storage mode. The id sets are
+	 * compared, so a delete and an insert that leave the count unchanged are
+	 * still caught: rows the database no longer has are dropped, and missing
+	 * ones are loaded SYNC_CHUNK_SIZE at a time.
+	 */
+	private syncIndex() {
+		if (!this.nativeIndex) return;
+
+		const idsResult = this.db.getIds();
+		if (idsResult.isErr()) {
+			this.close();
+			return;
+		}
+
+		const dbIds = new Set(idsResult.unwrap()!);
+		const indexIds = new Set(this.nativeIndex.ids());
+
+		for (const id of indexIds) {
+			if (!dbIds.has(id)) this.nativeIndex.remove(id);
+		}
+
+		const missing = [...dbIds].filter((id) => !indexIds.has(id));
+		for (let i = 0; i < missing.length; i += SYNC_CHUNK_SIZE) {
+			const messagesResult = this.db.getByIds(missing.slice(i, i + SYNC_CHUNK_SIZE));
+			if (messagesResult.isErr()) {
+				this.close();
+				return;
+			}
+			this.nativeIndex.addBatch(messagesResult.unwrap()!);
+		}
+	}
+
+	/**
+	 * Keep the index in step with an inserted message
+	 */
+	add(id: number, embedding: Float32Array) {
+		this.nativeIndex?.add(id, embedding);
+	}
+
+	remove(id: number) {
+		this.nativeIndex?.remove(id);
+	}
+
+	clear() {
+		this.nativeIndex?.clear();
+	}
+
+	close() {
+		this.nativeIndex?.close();
+		this.nativeIndex = null;
+	}
 
 	async search(query: string, topK: number = CONFIG.topK): Promise<Result<SearchResult[], DBError>> {
 		const embeddingResult = await this.embedder.embed(query);
@@ -32,6 +103,10 @@ export class SearchEngine {
 
 		const queryEmbedding = embeddingResult.unwrap()!;
 
+		if (this.nativeIndex) {
+			return this.searchIndex(this.nativeIndex, queryEmbedding, topK);
+		}
+
 		const messagesResult = this.db.getAllWithEmbeddings();
 
 		if (messagesResult.isErr()) {
@@ -54,6 +129,27 @@ export class SearchEngine {
 		return Result.ok(filtered);
 	}
 
+	private searchIndex(
+		index: NativeIndex,
+		queryEmbedding: Float32Array,
+		topK: number,
+	): Result<SearchResult[], DBError> {
+		const hits = index.search(queryEmbedding, topK, CONFIG.similarityThreshold);
+		const messagesResult = this.db.getByIds(hits.map((hit) => hit.id));
+
+		if (messagesResult.isErr()) {
+			return Result.err(messagesResult.unwrapErr()!);
+		}
+
+		const scores = new Map(hits.map((hit) => [hit.id, hit.score]));
+		const results = messagesResult.unwrap()!.map((message) => ({
+			message,
+			similarity: scores.get(message.id)!,
+		}));
+
+		return Result.ok(results);
+	}
+
 	async searchWithRecent(
 		query: string,
 		topK: number = CONFIG.topK,
@@ -8,9 +8,19 @@ import { DBError } from './errors';
 export { CONFIG } from './config';
 export { ChatDB, type Message, type MessageRole } from './core/database';
 export { Embedder } from './core/embed';
+export { NativeIndex } from './core/native';
 export { SearchEngine, type SearchResult } from './core/search-engine';
 export { DBError } from './errors';
 
+/**
+ * The vector index lives next to the database it mirrors; in-memory databases get none
+ */
+function indexPathFor(dbPath: string): string | undefined {
+	if (dbPath === ':memory:') return undefined;
+	if (dbPath === CONFIG.dbPath) return CONFIG.indexPath;
+	return `${dbPath.replace(/\.sqlite$/, '')}.vindex`;
+}
+
 export class VectorDB {
 	private db: ChatDB;
 	private embedder: Embedder;
@@ -19,7 +29,7 @@ export class VectorDB {
 	constructor(dbPath: string = CONFIG.dbPath) {
 		this.db = new ChatDB(dbPath);
 		this.embedder = new Embedder();
-		this.search = new SearchEngine(this.db, this.embedder);
+		this.search = new SearchEngine(this.db, this.embedder, indexPathFor(dbPath));
 	}
 
 	async warmup(): Promise<Result<void, DBError>> {
@@ -42,7 +52,10 @@ export class VectorDB {
 			return Result.err(insertResult.unwrapErr()!);
 		}
 
-		return Result.ok({ id: insertResult.unwrap()!, role, content, embedding, createdAt });
+		const id = insertResult.unwrap()!;
+		this.search.add(id, embedding);
+
+		return Result.ok({ id, role, content, embedding, createdAt });
 	}
 
 	async findSimilar(query: string, topK?: number): Promise<Result<SearchResult[], DBError>> {
@@ -66,14 +79,19 @@ export class VectorDB {
 	}
 
 	delete(id: number): Result<boolean, DBError> {
-		return this.db.delete(id);
+		const result = this.db.delete(id);
+		if (result.isOk()) this.search.remove(id);
+		return result;
 	}
 
 	clear(): Result<number, DBError> {
-		return this.db.clear();
+		const result = this.db.clear();
+		if (result.isOk()) this.search.clear();
+		return result;
 	}
 
 	close(): Result<void, DBError> {
+		this.search.close();
 		return this.db.close();
 	}
 }